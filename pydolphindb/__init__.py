@@ -1,4 +1,7 @@
 name = "pydolphindb"
 from .session import session
+from .pool import connectionPool
+from .writer import partitionedTableWriter
+from .writer import asyncWriter
 from .table import *
 from .vector import Vector
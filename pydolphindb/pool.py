@@ -0,0 +1,24 @@
+from .session import pydolphindbimpl
+
+
+class connectionPool(object):
+    """
+    a fixed number of connections to one DolphinDB server
+    run/upload check out an idle connection for each call, so they can be
+    issued concurrently from multiple threads; variables uploaded by one
+    call are only visible to the connection that served it
+    """
+    def __init__(self, host, port, size, userid="", password=""):
+        self.cpp = pydolphindbimpl.connectionPool(host, port, size, userid, password)
+
+    def upload(self, nameObjectDict):
+        return self.cpp.upload(nameObjectDict)
+
+    def run(self, script, *args):
+        return self.cpp.run(script, *args)
+
+    def close(self):
+        self.cpp.close()
+
+    def size(self):
+        return self.cpp.size()
@@ -63,28 +63,178 @@ class session(object):
     def upload(self, nameObjectDict):
         return self.cpp.upload(nameObjectDict)
 
+    def appendBatched(self, tableName, dataframe, batchRows):
+        """
+        insert a DataFrame into tableName batchRows rows at a time, the next
+        batch is converted while the previous one is sent, returns the rows
+        """
+        return self.cpp.appendBatched(tableName, dataframe, batchRows)
+
     def run(self, script, *args):
         return self.cpp.run(script, *args)
 
+    def runInto(self, script, buffers):
+        """
+        run and write the fixed width columns of the result into the numpy
+        arrays of the list buffers (one per column), arrays that are too
+        small or of another dtype are replaced in the list
+        """
+        return self.cpp.runInto(script, buffers)
+
+    def runArrow(self, script):
+        """
+        return a table result as pyarrow.Table (a vector as pyarrow.Array),
+        requires pyarrow >= 0.17
+        """
+        return self.cpp.runArrow(script)
+
+    def runChunked(self, script, chunkRows, reuseBuffers=False):
+        """
+        iterate a large table result in blocks of chunkRows (>= 8192) rows,
+        with reuseBuffers the numpy arrays of a block are overwritten by the
+        next one, the session is busy until the iterator is exhausted or closed
+        """
+        return self.cpp.runChunked(script, chunkRows, reuseBuffers)
+
+    def runAsync(self, script, *args):
+        """
+        run on a native worker thread and return a concurrent.futures.Future,
+        use asyncio.wrap_future to await it in a coroutine
+        """
+        return self.cpp.runAsync(script, *args)
+
     def nullValueToZero(self):
         self.cpp.nullValueToZero()
     
     def nullValueToNan(self):
         self.cpp.nullValueToNan()
 
-    def enableStreaming(self, port):
-        self.cpp.enableStreaming(port)
+    def nullValueToSentinel(self):
+        """
+        keep the DolphinDB null values (e.g. INT_MIN) and the integer dtypes
+        """
+        self.cpp.nullValueToSentinel()
+
+    def nullValueToMasked(self):
+        """
+        return BOOL, integral and floating vectors as numpy.ma.MaskedArray
+        """
+        self.cpp.nullValueToMasked()
+
+    def nullValueToNullable(self):
+        """
+        return BOOL and integral vectors as pandas nullable arrays
+        (boolean, Int8..Int64), requires pandas >= 1.0
+        """
+        self.cpp.nullValueToNullable()
+
+    def setTableFormat(self, format):
+        """
+        :param format: "dataframe" (default), "dict" of numpy arrays or "recarray"
+        """
+        self.cpp.setTableFormat(format)
+
+    def setMatrixFormat(self, format):
+        """
+        :param format: "list" (default) of [array, row labels, column labels] or labelled "dataframe"
+        """
+        self.cpp.setMatrixFormat(format)
+
+    def setConvertParallelism(self, parallelism):
+        """
+        :param parallelism: number of native threads converting the columns of a table result
+        """
+        self.cpp.setConvertParallelism(parallelism)
+
+    def setSymbolAsCategorical(self, enable=True):
+        """
+        :param enable: return SYMBOL vectors as pandas.Categorical instead of object arrays
+        """
+        self.cpp.setSymbolAsCategorical(enable)
+
+    def setStringAsSymbol(self, enable=True):
+        """
+        :param enable: upload str columns of DataFrames as SYMBOL instead of STRING
+        """
+        self.cpp.setStringAsSymbol(enable)
+
+    def setResultBuffers(self, enable=True):
+        """
+        :param enable: let run write fixed width columns into a pool of numpy
+        arrays owned by the session, a result is overwritten by the next one;
+        threads sharing the session convert into the pool one at a time. A
+        table returned as pandas.DataFrame may consolidate (copy) the arrays,
+        use setTableFormat("dict") to get views of the pool itself
+        """
+        self.cpp.setResultBuffers(enable)
+
+    def enableStreaming(self, port, workers=0, cpus=None):
+        """
+        :param workers: if positive, handle the messages on this many native worker threads instead of the receiver threads
+        :param cpus: CPU ids the workers are pinned to, round robin
+        """
+        if getattr(self, "streaming", None) is None:
+            self.streaming = pydolphindbimpl.streaming()
+        if workers > 0:
+            self.streaming.setWorkers(workers, cpus if cpus is not None else [])
+        self.streaming.listen(port)
 
-    def subscribe(self, host, port, handler, tableName, actionName="", offset=-1, resub=False, filter=None):
+    def subscribe(self, host, port, handler, tableName, actionName="", offset=-1, resub=False, filter=None, batchSize=0, throttle=100, keyColumn=-1):
+        """
+        :param batchSize: if positive, handler receives a dict of column name to numpy array for up to batchSize messages instead of a list of values per message;
+            the names are read from the stream table once, on a connection to host:port without login
+        :param throttle: milliseconds a batch waits for more messages at most
+        :param keyColumn: with workers, spread the topic over all of them by the hash of this column (messages of one key stay in order)
+        """
         if filter is None:
             filter = np.array([],dtype='int64')
-        self.cpp.subscribe(host, port, handler, tableName, actionName, offset, resub, filter)
+        self._streaming().subscribe(host, port, handler, tableName, actionName, offset, resub, filter, batchSize, throttle, keyColumn)
+
+    def subscribeNative(self, host, port, callback, tableName, actionName="", offset=-1, resub=False, filter=None, batchSize=1, throttle=100, keyColumn=-1, userData=0):
+        """
+        :param callback: a PyCapsule or the address (e.g. numba cfunc.address) of a C function
+            void(const void* const* columns, const int* types, int ncols, long long nrows, void* userData)
+            called per batch without the GIL, on the receiver or worker thread or, for a batch flushed after throttle,
+            on a timer thread; batches of a topic never overlap; columns hold raw DolphinDB values (char* arrays for strings)
+        :param userData: an address passed back to callback
+        """
+        if filter is None:
+            filter = np.array([],dtype='int64')
+        self._streaming().subscribeNative(host, port, callback, tableName, actionName, offset, resub, filter, batchSize, throttle, keyColumn, userData)
+
+    def subscribeAggregated(self, host, port, handler, tableName, keyColumn, timeColumn, window, aggregators, actionName="", offset=-1, resub=False, filter=None):
+        """
+        aggregate natively per key over tumbling windows of the time column, handler receives
+        a dict of column arrays (key, time, then function_column per aggregator, function_column_arg
+        for vwap and the rolling functions) for the closed windows
+        :param window: window length in the units of the time column (e.g. ms for TIMESTAMP)
+        :param aggregators: tuples (function, column[, arg]) with function first, last, max, min, sum,
+            count, vwap (arg: volume column), rollingMean or rollingStd (arg: number of ticks)
+        """
+        if filter is None:
+            filter = np.array([],dtype='int64')
+        self._streaming().subscribeAggregated(host, port, handler, tableName, actionName, offset, resub, filter, keyColumn, timeColumn, window, aggregators)
+
+    def subscribePolling(self, host, port, tableName, actionName="", offset=-1, resub=False, filter=None, capacity=1 << 20):
+        """
+        buffer the messages in a ring of capacity rows without entering Python,
+        the returned poller's poll(maxRows=0, timeout=0) drains them as a list
+        of column arrays, a full ring holds up the receiver until it is polled
+        """
+        if filter is None:
+            filter = np.array([],dtype='int64')
+        return self._streaming().subscribePolling(host, port, tableName, actionName, offset, resub, filter, capacity)
 
     def unsubscribe(self, host, port, tableName, actionName=""):
-        self.cpp.unsubscribe(host, port, tableName, actionName)
+        self._streaming().unsubscribe(host, port, tableName, actionName)
 
     def getSubscriptionTopics(self):
-        return self.cpp.getSubscriptionTopics()
+        return self._streaming().getSubscriptionTopics()
+
+    def _streaming(self):
+        if getattr(self, "streaming", None) is None:
+            raise RuntimeError("streaming is not enabled, call enableStreaming first")
+        return self.streaming
 
     def table(self, data, dbPath=None):
         return Table(data=data, dbPath=dbPath, s=self)
@@ -0,0 +1,64 @@
+from .session import pydolphindbimpl
+
+
+class partitionedTableWriter(object):
+    """
+    append DataFrames to a DFS table from threads native threads, rows are
+    routed by the partition of partitionColumn (one of the partition columns
+    of the table) so each partition is written by one thread on its own
+    connection; a thread writes after batchSize rows or throttle
+    milliseconds, use dbPath="" for a shared in-memory table
+    """
+    def __init__(self, host, port, dbPath, tableName, partitionColumn,
+                 threads=4, batchSize=10000, throttle=100,
+                 userid="", password=""):
+        self.cpp = pydolphindbimpl.partitionedTableWriter(
+            host, port, userid, password, dbPath, tableName,
+            partitionColumn, threads, batchSize, throttle)
+
+    def insert(self, dataframe):
+        self.cpp.insert(dataframe)
+
+    def flush(self):
+        """
+        wait until every queued row is written, raises a failed write
+        """
+        self.cpp.flush()
+
+    def pending(self):
+        return self.cpp.pending()
+
+    def close(self):
+        self.cpp.close()
+
+
+class asyncWriter(object):
+    """
+    buffer rows for tableName (e.g. "t" or 'loadTable("dfs://db", "t")') and
+    insert them from a background thread once batchSize rows are buffered or
+    throttle milliseconds after the first one; onError(message) is called
+    for a failed insert, without it the error is raised by the next call
+    """
+    def __init__(self, host, port, tableName, batchSize=10000, throttle=100,
+                 onError=None, userid="", password=""):
+        self.cpp = pydolphindbimpl.asyncWriter(
+            host, port, userid, password, tableName, batchSize, throttle,
+            onError)
+
+    def insert(self, *row):
+        self.cpp.insert(*row)
+
+    def insertBatch(self, dataframe):
+        self.cpp.insertBatch(dataframe)
+
+    def flush(self):
+        """
+        wait until every queued row is written
+        """
+        self.cpp.flush()
+
+    def pending(self):
+        return self.cpp.pending()
+
+    def close(self):
+        self.cpp.close()
@@ -0,0 +1,904 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <pybind11/pybind11.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <DolphinDB.h>
+#include <Util.h>
+
+#include "Arrow.h"
+#include "Kernels.h"
+
+namespace pydolphindb
+{
+
+namespace arrow
+{
+
+namespace
+{
+
+// blocks start on a byte of a bitmap, so the size is a multiple of 8
+const size_t blockSize = 4096;
+
+// everything an exported array points to, freed by its release callback
+struct ExportedArray {
+  std::vector<const void*> buffers;
+  // the vector whose own buffer is exported
+  ddb::VectorSP shared;
+  std::vector<std::vector<char>> storage;
+  std::vector<ArrowArray> children;
+  std::vector<ArrowArray*> childPointers;
+  std::unique_ptr<ArrowArray> dictionary;
+};
+
+struct ExportedSchema {
+  std::string format;
+  std::string name;
+  std::vector<ArrowSchema> children;
+  std::vector<ArrowSchema*> childPointers;
+  std::unique_ptr<ArrowSchema> dictionary;
+};
+
+void releaseArray(ArrowArray *array)
+{
+  auto *data = static_cast<ExportedArray*>(array->private_data);
+  for (auto &child : data->children) {
+    if (child.release != nullptr) {
+      child.release(&child);
+    }
+  }
+  if (data->dictionary && data->dictionary->release != nullptr) {
+    data->dictionary->release(data->dictionary.get());
+  }
+  delete data;
+  array->release = nullptr;
+}
+
+void releaseSchema(ArrowSchema *schema)
+{
+  auto *data = static_cast<ExportedSchema*>(schema->private_data);
+  for (auto &child : data->children) {
+    if (child.release != nullptr) {
+      child.release(&child);
+    }
+  }
+  if (data->dictionary && data->dictionary->release != nullptr) {
+    data->dictionary->release(data->dictionary.get());
+  }
+  delete data;
+  schema->release = nullptr;
+}
+
+// releases the structs unless the consumer moved them out
+struct ArrowGuard {
+  ArrowArray *array;
+  ArrowSchema *schema;
+  ~ArrowGuard()
+  {
+    if (array->release != nullptr) {
+      array->release(array);
+    }
+    if (schema->release != nullptr) {
+      schema->release(schema);
+    }
+  }
+};
+
+ExportedArray *initArray(ArrowArray *array, int64_t length)
+{
+  auto *data = new ExportedArray();
+  array->length = length;
+  array->null_count = 0;
+  array->offset = 0;
+  array->n_buffers = 0;
+  array->n_children = 0;
+  array->buffers = nullptr;
+  array->children = nullptr;
+  array->dictionary = nullptr;
+  array->release = releaseArray;
+  array->private_data = data;
+  return data;
+}
+
+ExportedSchema *initSchema(
+  ArrowSchema *schema,
+  const std::string &format,
+  const std::string &name)
+{
+  auto *data = new ExportedSchema();
+  data->format = format;
+  data->name = name;
+  schema->format = data->format.c_str();
+  schema->name = data->name.c_str();
+  schema->metadata = nullptr;
+  schema->flags = ARROW_FLAG_NULLABLE;
+  schema->n_children = 0;
+  schema->children = nullptr;
+  schema->dictionary = nullptr;
+  schema->release = releaseSchema;
+  schema->private_data = data;
+  return data;
+}
+
+void setBuffers(ArrowArray *array, ExportedArray *data)
+{
+  array->n_buffers = static_cast<int64_t>(data->buffers.size());
+  array->buffers = data->buffers.data();
+}
+
+// a buffer owned by the exported array, never empty so it is never null
+char *allocate(ExportedArray *data, size_t bytes)
+{
+  data->storage.emplace_back(std::max<size_t>(bytes, 8));
+  return data->storage.back().data();
+}
+
+// pack 0/1 bytes into a bitmap, least significant bit first; the multiply
+// gathers the low bit of 8 little endian bytes into the top byte
+void packBits(const bool *bytes, uint8_t *bits, size_t len, bool invert)
+{
+  for (size_t i = 0; i < len; i += 8) {
+    uint64_t x = 0;
+    std::memcpy(&x, bytes + i, std::min<size_t>(8, len - i));
+    uint8_t b = static_cast<uint8_t>((x * 0x0102040810204080ULL) >> 56);
+    bits[i / 8] = invert ? static_cast<uint8_t>(~b) : b;
+  }
+}
+
+// validity bitmap from the null sentinels, nullptr when there is no null
+template <typename T>
+const void *validity(
+  const ddb::VectorSP &vec,
+  size_t size,
+  ExportedArray *data,
+  int64_t &nullCount)
+{
+  nullCount = 0;
+  if (!vec->hasNull()) {
+    return nullptr;
+  }
+  uint8_t *bits = reinterpret_cast<uint8_t*>(allocate(data, (size + 7) / 8));
+  T buf[blockSize];
+  bool mask[blockSize];
+  for (size_t start = 0; start < size; start += blockSize) {
+    int len = static_cast<int>(std::min(blockSize, size - start));
+    const T *src = utils::getConst(
+      vec, static_cast<ddb::INDEX>(start), len, buf);
+    kernels::nullMask(src, mask, len);
+    for (int i = 0; i < len; ++i) {
+      nullCount += mask[i];
+    }
+    packBits(mask, bits + start / 8, len, true);
+  }
+  return bits;
+}
+
+template <typename T>
+void copyBlock(const T *src, T *dst, size_t len)
+{
+  std::memcpy(dst, src, len * sizeof(T));
+}
+
+// the vector's own buffer when it is contiguous, a copy otherwise
+template <typename T>
+const void *values(const ddb::VectorSP &vec, size_t size, ExportedArray *data)
+{
+  if (size > 0 && vec->isFastMode() && vec->getDataArray() != nullptr) {
+    data->shared = vec;
+    return vec->getDataArray();
+  }
+  T *dst = reinterpret_cast<T*>(allocate(data, size * sizeof(T)));
+  utils::convertByBlock<T, T>(vec, dst, size, copyBlock);
+  return dst;
+}
+
+// values mapped one by one to another Arrow type, nulls are skipped
+template <typename T, typename D, typename Convert>
+const void *convertedValues(
+  const ddb::VectorSP &vec,
+  size_t size,
+  ExportedArray *data,
+  T null,
+  Convert convert)
+{
+  D *dst = reinterpret_cast<D*>(allocate(data, size * sizeof(D)));
+  T buf[blockSize];
+  for (size_t start = 0; start < size; start += blockSize) {
+    int len = static_cast<int>(std::min(blockSize, size - start));
+    const T *src = utils::getConst(
+      vec, static_cast<ddb::INDEX>(start), len, buf);
+    for (int i = 0; i < len; ++i) {
+      dst[start + i] = src[i] == null ? D() : convert(src[i]);
+    }
+  }
+  return dst;
+}
+
+const void *boolValues(const ddb::VectorSP &vec, size_t size,
+  ExportedArray *data)
+{
+  uint8_t *bits = reinterpret_cast<uint8_t*>(allocate(data, (size + 7) / 8));
+  char buf[blockSize];
+  bool bytes[blockSize];
+  for (size_t start = 0; start < size; start += blockSize) {
+    int len = static_cast<int>(std::min(blockSize, size - start));
+    const char *src = utils::getConst(
+      vec, static_cast<ddb::INDEX>(start), len, buf);
+    for (int i = 0; i < len; ++i) {
+      bytes[i] = src[i] == 1;
+    }
+    packBits(bytes, bits + start / 8, len, false);
+  }
+  return bits;
+}
+
+// days since 1970-01-01 of a proleptic Gregorian date
+int daysFromCivil(int y, unsigned m, unsigned d)
+{
+  y -= m <= 2;
+  const int era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(y - era * 400);
+  const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<int>(doe) - 719468;
+}
+
+// utf8 (or large utf8) layout of size strings, empty strings are null as in
+// DolphinDB; returns the format
+template <typename Get>
+std::string fillUtf8(ArrowArray *array, ExportedArray *data, size_t size,
+  Get get)
+{
+  std::vector<int64_t> offsets(size + 1, 0);
+  std::unique_ptr<bool[]> isNull(new bool[size + 1]);
+  std::vector<char> chars;
+  int64_t nullCount = 0;
+  for (size_t i = 0; i < size; ++i) {
+    std::string str = get(i);
+    isNull[i] = str.empty();
+    nullCount += isNull[i];
+    chars.insert(chars.end(), str.begin(), str.end());
+    offsets[i + 1] = static_cast<int64_t>(chars.size());
+  }
+  const void *bitmap = nullptr;
+  if (nullCount > 0) {
+    uint8_t *bits = reinterpret_cast<uint8_t*>(
+      allocate(data, (size + 7) / 8));
+    packBits(isNull.get(), bits, size, true);
+    bitmap = bits;
+  }
+  std::string format;
+  const void *offsetBuffer;
+  if (chars.size() <= static_cast<size_t>(INT32_MAX)) {
+    int32_t *o = reinterpret_cast<int32_t*>(
+      allocate(data, (size + 1) * sizeof(int32_t)));
+    std::copy(offsets.begin(), offsets.end(), o);
+    offsetBuffer = o;
+    format = "u";
+  } else {
+    int64_t *o = reinterpret_cast<int64_t*>(
+      allocate(data, (size + 1) * sizeof(int64_t)));
+    std::copy(offsets.begin(), offsets.end(), o);
+    offsetBuffer = o;
+    format = "U";
+  }
+  chars.resize(std::max<size_t>(chars.size(), 8));
+  data->storage.push_back(std::move(chars));
+  data->buffers = {bitmap, offsetBuffer, data->storage.back().data()};
+  array->null_count = nullCount;
+  setBuffers(array, data);
+  return format;
+}
+
+// int32 indices into a utf8 dictionary of the distinct symbols
+void exportSymbols(const ddb::VectorSP &vec, size_t size,
+  ArrowArray *array, ExportedArray *data, ExportedSchema *schemaData,
+  ArrowSchema *schema)
+{
+  const int unseen = -2;
+  // the vector holds indices into its symbol base, the string of an index
+  // is asked for once and mapped to a dictionary code (-1 for null)
+  std::vector<int> codeOf;
+  std::vector<std::string> dictionary;
+  int32_t *indices = reinterpret_cast<int32_t*>(
+    allocate(data, size * sizeof(int32_t)));
+  std::unique_ptr<bool[]> isNull(new bool[size + 1]);
+  int64_t nullCount = 0;
+  int buf[blockSize];
+  for (size_t start = 0; start < size; start += blockSize) {
+    int len = static_cast<int>(std::min(blockSize, size - start));
+    const int *symbols = utils::getConst(
+      vec, static_cast<ddb::INDEX>(start), len, buf);
+    for (int j = 0; j < len; ++j) {
+      size_t i = start + j;
+      size_t symbol = static_cast<size_t>(symbols[j]);
+      if (symbol >= codeOf.size()) {
+        codeOf.resize(symbol + 1, unseen);
+      }
+      if (codeOf[symbol] == unseen) {
+        std::string str = vec->getString(static_cast<ddb::INDEX>(i));
+        if (str.empty()) {
+          codeOf[symbol] = -1;
+        } else {
+          codeOf[symbol] = static_cast<int>(dictionary.size());
+          dictionary.push_back(std::move(str));
+        }
+      }
+      isNull[i] = codeOf[symbol] < 0;
+      nullCount += isNull[i];
+      indices[i] = isNull[i] ? 0 : codeOf[symbol];
+    }
+  }
+  const void *bitmap = nullptr;
+  if (nullCount > 0) {
+    uint8_t *bits = reinterpret_cast<uint8_t*>(
+      allocate(data, (size + 7) / 8));
+    packBits(isNull.get(), bits, size, true);
+    bitmap = bits;
+  }
+  data->buffers = {bitmap, indices};
+  array->null_count = nullCount;
+  setBuffers(array, data);
+
+  data->dictionary.reset(new ArrowArray());
+  ArrowArray *dictArray = data->dictionary.get();
+  ExportedArray *dictData = initArray(dictArray, dictionary.size());
+  std::string format = fillUtf8(dictArray, dictData, dictionary.size(),
+    [&](size_t i) { return dictionary[i]; });
+  array->dictionary = dictArray;
+  schemaData->dictionary.reset(new ArrowSchema());
+  initSchema(schemaData->dictionary.get(), format, "");
+  schema->dictionary = schemaData->dictionary.get();
+}
+
+// fill array and schema with the Arrow layout of a vector, runs without
+// the GIL
+void exportVector(const ddb::VectorSP &vec, const std::string &name,
+  ArrowArray *array, ArrowSchema *schema)
+{
+  size_t size = vec->size();
+  ExportedArray *data = initArray(array, size);
+  ExportedSchema *schemaData = initSchema(schema, "n", name);
+  int64_t nullCount = 0;
+  std::string format;
+  ddb::DATA_TYPE type = vec->getType();
+  switch (type) {
+    case ddb::DT_BOOL:
+      data->buffers = {validity<char>(vec, size, data, nullCount),
+        boolValues(vec, size, data)};
+      format = "b";
+      break;
+    case ddb::DT_CHAR:
+      data->buffers = {validity<char>(vec, size, data, nullCount),
+        values<char>(vec, size, data)};
+      format = "c";
+      break;
+    case ddb::DT_SHORT:
+      data->buffers = {validity<short>(vec, size, data, nullCount),
+        values<short>(vec, size, data)};
+      format = "s";
+      break;
+    case ddb::DT_INT:
+      data->buffers = {validity<int>(vec, size, data, nullCount),
+        values<int>(vec, size, data)};
+      format = "i";
+      break;
+    case ddb::DT_LONG:
+      data->buffers = {validity<long long>(vec, size, data, nullCount),
+        values<long long>(vec, size, data)};
+      format = "l";
+      break;
+    case ddb::DT_FLOAT:
+      data->buffers = {validity<float>(vec, size, data, nullCount),
+        values<float>(vec, size, data)};
+      format = "f";
+      break;
+    case ddb::DT_DOUBLE:
+      data->buffers = {validity<double>(vec, size, data, nullCount),
+        values<double>(vec, size, data)};
+      format = "g";
+      break;
+    case ddb::DT_DATE:
+      // days since epoch, exactly date32
+      data->buffers = {validity<int>(vec, size, data, nullCount),
+        values<int>(vec, size, data)};
+      format = "tdD";
+      break;
+    case ddb::DT_MONTH:
+      // months since year 0, as the first day of the month
+      data->buffers = {validity<int>(vec, size, data, nullCount),
+        convertedValues<int, int>(vec, size, data, INT_MIN, [](int m) {
+          return daysFromCivil(m / 12, m % 12 + 1, 1);
+        })};
+      format = "tdD";
+      break;
+    case ddb::DT_TIME:
+      data->buffers = {validity<int>(vec, size, data, nullCount),
+        values<int>(vec, size, data)};
+      format = "ttm";
+      break;
+    case ddb::DT_MINUTE:
+      data->buffers = {validity<int>(vec, size, data, nullCount),
+        convertedValues<int, int>(vec, size, data, INT_MIN, [](int m) {
+          return m * 60;
+        })};
+      format = "tts";
+      break;
+    case ddb::DT_SECOND:
+      data->buffers = {validity<int>(vec, size, data, nullCount),
+        values<int>(vec, size, data)};
+      format = "tts";
+      break;
+    case ddb::DT_DATETIME:
+      data->buffers = {validity<int>(vec, size, data, nullCount),
+        convertedValues<int, long long>(vec, size, data, INT_MIN, [](int s) {
+          return static_cast<long long>(s);
+        })};
+      format = "tss:";
+      break;
+    case ddb::DT_TIMESTAMP:
+      data->buffers = {validity<long long>(vec, size, data, nullCount),
+        values<long long>(vec, size, data)};
+      format = "tsm:";
+      break;
+    case ddb::DT_NANOTIME:
+      data->buffers = {validity<long long>(vec, size, data, nullCount),
+        values<long long>(vec, size, data)};
+      format = "ttn";
+      break;
+    case ddb::DT_NANOTIMESTAMP:
+      data->buffers = {validity<long long>(vec, size, data, nullCount),
+        values<long long>(vec, size, data)};
+      format = "tsn:";
+      break;
+    case ddb::DT_STRING:
+      format = fillUtf8(array, data, size,
+        [&](size_t i) { return vec->getString(i); });
+      break;
+    case ddb::DT_SYMBOL:
+      exportSymbols(vec, size, array, data, schemaData, schema);
+      format = "i";
+      break;
+    default:
+      throw std::runtime_error(
+        "<Python API Exception> no arrow type for " +
+        utils::DataTypeToString(type) + " column " + name);
+  }
+  if (type != ddb::DT_STRING && type != ddb::DT_SYMBOL) {
+    array->null_count = nullCount;
+    setBuffers(array, data);
+  }
+  schemaData->format = format;
+  schema->format = schemaData->format.c_str();
+}
+
+// a struct array with one child per column, the layout of a RecordBatch
+void exportTable(const ddb::TableSP &tbl, ArrowArray *array,
+  ArrowSchema *schema)
+{
+  size_t columnSize = tbl->columns();
+  ExportedArray *data = initArray(array, tbl->size());
+  ExportedSchema *schemaData = initSchema(schema, "+s", "");
+  schema->flags = 0;
+  data->buffers = {nullptr};
+  setBuffers(array, data);
+  data->children.resize(columnSize, ArrowArray());
+  schemaData->children.resize(columnSize, ArrowSchema());
+  for (size_t i = 0; i < columnSize; ++i) {
+    data->childPointers.push_back(&data->children[i]);
+    schemaData->childPointers.push_back(&schemaData->children[i]);
+  }
+  array->n_children = static_cast<int64_t>(columnSize);
+  array->children = data->childPointers.data();
+  schema->n_children = static_cast<int64_t>(columnSize);
+  schema->children = schemaData->childPointers.data();
+  for (size_t i = 0; i < columnSize; ++i) {
+    exportVector(tbl->getColumn(i), tbl->getColumnName(i),
+      &data->children[i], &schemaData->children[i]);
+  }
+}
+
+py::int_ address(const void *p)
+{
+  return py::int_(reinterpret_cast<uintptr_t>(p));
+}
+
+// element i of a (sliced) array; base is the offset of a parent struct
+struct ArrowColumn {
+  const ArrowArray *array;
+  const ArrowSchema *schema;
+  int64_t base;
+  int64_t length;
+
+  int64_t index(int64_t i) const
+  {
+    return array->offset + base + i;
+  }
+
+  bool isValid(int64_t i) const
+  {
+    const uint8_t *bits = static_cast<const uint8_t*>(array->buffers[0]);
+    if (array->null_count == 0 || bits == nullptr) {
+      return true;
+    }
+    int64_t j = index(i);
+    return (bits[j >> 3] >> (j & 7)) & 1;
+  }
+
+  template <typename T>
+  const T *buffer(int k) const
+  {
+    return static_cast<const T*>(array->buffers[k]);
+  }
+};
+
+// append the values of a fixed width column block by block, nulls become
+// null, convert maps an Arrow value to the DolphinDB one
+template <typename S, typename D, typename Convert, typename Append>
+void importFixed(const ArrowColumn &column, D null, Convert convert,
+  Append append)
+{
+  const S *src = column.buffer<S>(1);
+  D buf[blockSize];
+  for (int64_t start = 0; start < column.length; start += blockSize) {
+    int len = static_cast<int>(
+      std::min<int64_t>(blockSize, column.length - start));
+    for (int i = 0; i < len; ++i) {
+      int64_t k = start + i;
+      buf[i] = column.isValid(k) ?
+        static_cast<D>(convert(src[column.index(k)])) : null;
+    }
+    append(buf, len);
+  }
+}
+
+template <typename T>
+T identity(T v)
+{
+  return v;
+}
+
+template <typename O>
+std::string utf8At(const ArrowColumn &column, int64_t i)
+{
+  if (!column.isValid(i)) {
+    return std::string();
+  }
+  const O *offsets = column.buffer<O>(1);
+  const char *chars = column.buffer<char>(2);
+  int64_t j = column.index(i);
+  return std::string(chars + offsets[j],
+    static_cast<size_t>(offsets[j + 1] - offsets[j]));
+}
+
+template <typename Get>
+ddb::VectorSP importStrings(ddb::DATA_TYPE type, int64_t length, Get get)
+{
+  ddb::VectorSP vec = ddb::Util::createVector(type, 0, length);
+  std::vector<std::string> buf(1024);
+  for (int64_t start = 0; start < length; start += 1024) {
+    int len = static_cast<int>(std::min<int64_t>(1024, length - start));
+    for (int i = 0; i < len; ++i) {
+      buf[i] = get(start + i);
+    }
+    vec->appendString(buf.data(), len);
+  }
+  return vec;
+}
+
+template <typename I>
+ddb::VectorSP importDictionary(const ArrowColumn &column,
+  const std::vector<std::string> &dictionary)
+{
+  const I *indices = column.buffer<I>(1);
+  return importStrings(ddb::DT_SYMBOL, column.length, [&](int64_t i) {
+    return column.isValid(i) ?
+      dictionary[indices[column.index(i)]] : std::string();
+  });
+}
+
+bool startsWith(const std::string &str, const char *prefix)
+{
+  return str.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+ddb::VectorSP importVector(const ArrowColumn &column);
+
+ddb::VectorSP importSymbols(const ArrowColumn &column)
+{
+  ArrowColumn values{column.array->dictionary, column.schema->dictionary,
+    0, column.array->dictionary->length};
+  std::string valueFormat(values.schema->format);
+  if (valueFormat != "u" && valueFormat != "U") {
+    throw std::runtime_error("<Python API Exception> arrow dictionary of " +
+      valueFormat + " is not supported, expect utf8");
+  }
+  std::vector<std::string> dictionary(values.length);
+  for (int64_t i = 0; i < values.length; ++i) {
+    dictionary[i] = valueFormat == "u" ?
+      utf8At<int32_t>(values, i) : utf8At<int64_t>(values, i);
+  }
+  std::string format(column.schema->format);
+  if (format == "c") {
+    return importDictionary<int8_t>(column, dictionary);
+  } else if (format == "s") {
+    return importDictionary<int16_t>(column, dictionary);
+  } else if (format == "i") {
+    return importDictionary<int32_t>(column, dictionary);
+  } else if (format == "l") {
+    return importDictionary<int64_t>(column, dictionary);
+  }
+  throw std::runtime_error(
+    "<Python API Exception> arrow dictionary index " + format +
+    " is not supported");
+}
+
+ddb::VectorSP importVector(const ArrowColumn &column)
+{
+  if (column.schema->dictionary != nullptr) {
+    return importSymbols(column);
+  }
+  std::string format(column.schema->format);
+  int64_t length = column.length;
+  ddb::VectorSP vec;
+  auto appendChar = [&](char *buf, int len) { vec->appendChar(buf, len); };
+  auto appendShort = [&](short *buf, int len) { vec->appendShort(buf, len); };
+  auto appendInt = [&](int *buf, int len) { vec->appendInt(buf, len); };
+  auto appendLong = [&](long long *buf, int len) {
+    vec->appendLong(buf, len);
+  };
+  auto appendFloat = [&](float *buf, int len) { vec->appendFloat(buf, len); };
+  auto appendDouble = [&](double *buf, int len) {
+    vec->appendDouble(buf, len);
+  };
+  const char nullChar = static_cast<char>(INT8_MIN);
+  const short nullShort = static_cast<short>(INT16_MIN);
+  const long long nullLong = LLONG_MIN;
+  if (format == "b") {
+    vec = ddb::Util::createVector(ddb::DT_BOOL, 0, length);
+    const uint8_t *bits = column.buffer<uint8_t>(1);
+    char buf[blockSize];
+    for (int64_t start = 0; start < length; start += blockSize) {
+      int len = static_cast<int>(std::min<int64_t>(blockSize, length - start));
+      for (int i = 0; i < len; ++i) {
+        int64_t j = column.index(start + i);
+        buf[i] = column.isValid(start + i) ?
+          static_cast<char>((bits[j >> 3] >> (j & 7)) & 1) : nullChar;
+      }
+      vec->appendBool(buf, len);
+    }
+  } else if (format == "c") {
+    vec = ddb::Util::createVector(ddb::DT_CHAR, 0, length);
+    importFixed<int8_t, char>(column, nullChar, identity<int8_t>, appendChar);
+  } else if (format == "C") {
+    vec = ddb::Util::createVector(ddb::DT_SHORT, 0, length);
+    importFixed<uint8_t, short>(
+      column, nullShort, identity<uint8_t>, appendShort);
+  } else if (format == "s") {
+    vec = ddb::Util::createVector(ddb::DT_SHORT, 0, length);
+    importFixed<int16_t, short>(
+      column, nullShort, identity<int16_t>, appendShort);
+  } else if (format == "S") {
+    vec = ddb::Util::createVector(ddb::DT_INT, 0, length);
+    importFixed<uint16_t, int>(column, INT_MIN, identity<uint16_t>, appendInt);
+  } else if (format == "i") {
+    vec = ddb::Util::createVector(ddb::DT_INT, 0, length);
+    importFixed<int32_t, int>(column, INT_MIN, identity<int32_t>, appendInt);
+  } else if (format == "I") {
+    vec = ddb::Util::createVector(ddb::DT_LONG, 0, length);
+    importFixed<uint32_t, long long>(
+      column, nullLong, identity<uint32_t>, appendLong);
+  } else if (format == "l") {
+    vec = ddb::Util::createVector(ddb::DT_LONG, 0, length);
+    importFixed<int64_t, long long>(
+      column, nullLong, identity<int64_t>, appendLong);
+  } else if (format == "f") {
+    vec = ddb::Util::createVector(ddb::DT_FLOAT, 0, length);
+    importFixed<float, float>(
+      column, ddb::FLT_NMIN, identity<float>, appendFloat);
+  } else if (format == "g") {
+    vec = ddb::Util::createVector(ddb::DT_DOUBLE, 0, length);
+    importFixed<double, double>(
+      column, ddb::DBL_NMIN, identity<double>, appendDouble);
+  } else if (format == "tdD") {
+    vec = ddb::Util::createVector(ddb::DT_DATE, 0, length);
+    importFixed<int32_t, int>(column, INT_MIN, identity<int32_t>, appendInt);
+  } else if (format == "tdm") {
+    vec = ddb::Util::createVector(ddb::DT_DATE, 0, length);
+    importFixed<int64_t, int>(column, INT_MIN, [](int64_t ms) {
+      return ms >= 0 ? ms / 86400000 : (ms - 86399999) / 86400000;
+    }, appendInt);
+  } else if (format == "tts") {
+    vec = ddb::Util::createVector(ddb::DT_SECOND, 0, length);
+    importFixed<int32_t, int>(column, INT_MIN, identity<int32_t>, appendInt);
+  } else if (format == "ttm") {
+    vec = ddb::Util::createVector(ddb::DT_TIME, 0, length);
+    importFixed<int32_t, int>(column, INT_MIN, identity<int32_t>, appendInt);
+  } else if (format == "ttu") {
+    vec = ddb::Util::createVector(ddb::DT_NANOTIME, 0, length);
+    importFixed<int64_t, long long>(column, nullLong, [](int64_t us) {
+      return us * 1000;
+    }, appendLong);
+  } else if (format == "ttn") {
+    vec = ddb::Util::createVector(ddb::DT_NANOTIME, 0, length);
+    importFixed<int64_t, long long>(
+      column, nullLong, identity<int64_t>, appendLong);
+  } else if (startsWith(format, "tss:")) {
+    vec = ddb::Util::createVector(ddb::DT_DATETIME, 0, length);
+    importFixed<int64_t, int>(column, INT_MIN, identity<int64_t>, appendInt);
+  } else if (startsWith(format, "tsm:")) {
+    vec = ddb::Util::createVector(ddb::DT_TIMESTAMP, 0, length);
+    importFixed<int64_t, long long>(
+      column, nullLong, identity<int64_t>, appendLong);
+  } else if (startsWith(format, "tsu:")) {
+    vec = ddb::Util::createVector(ddb::DT_NANOTIMESTAMP, 0, length);
+    importFixed<int64_t, long long>(column, nullLong, [](int64_t us) {
+      return us * 1000;
+    }, appendLong);
+  } else if (startsWith(format, "tsn:")) {
+    vec = ddb::Util::createVector(ddb::DT_NANOTIMESTAMP, 0, length);
+    importFixed<int64_t, long long>(
+      column, nullLong, identity<int64_t>, appendLong);
+  } else if (format == "u") {
+    return importStrings(ddb::DT_STRING, length, [&](int64_t i) {
+      return utf8At<int32_t>(column, i);
+    });
+  } else if (format == "U") {
+    return importStrings(ddb::DT_STRING, length, [&](int64_t i) {
+      return utf8At<int64_t>(column, i);
+    });
+  } else {
+    throw std::runtime_error("<Python API Exception> arrow format " +
+      format + " of column " + std::string(column.schema->name) +
+      " is not supported");
+  }
+  vec->setNullFlag(column.array->null_count != 0);
+  return vec;
+}
+
+// the columns of a RecordBatch, appended to names/columns when they are
+// still empty or to the existing columns otherwise
+void importBatch(py::object batch, std::vector<std::string> &names,
+  std::vector<ddb::VectorSP> &columns)
+{
+  ArrowArray array = ArrowArray();
+  ArrowSchema schema = ArrowSchema();
+  ArrowGuard guard{&array, &schema};
+  batch.attr("_export_to_c")(address(&array), address(&schema));
+  if (std::string(schema.format) != "+s") {
+    throw std::runtime_error(
+      "<Python API Exception> arrow record batch is not a struct array");
+  }
+  py::gil_scoped_release release;
+  bool first = columns.empty();
+  for (int64_t i = 0; i < schema.n_children; ++i) {
+    ArrowColumn column{array.children[i], schema.children[i],
+      array.offset, array.length};
+    ddb::VectorSP vec = importVector(column);
+    if (first) {
+      names.emplace_back(schema.children[i]->name);
+      columns.push_back(vec);
+    } else {
+      columns[i]->append(vec);
+    }
+  }
+}
+
+ddb::TableSP createTable(const std::vector<std::string> &names,
+  const std::vector<ddb::VectorSP> &columns)
+{
+  std::vector<ddb::ConstantSP> cols(columns.begin(), columns.end());
+  return ddb::Util::createTable(names, cols);
+}
+
+}  // namespace
+
+py::object toArrow(ddb::ConstantSP obj)
+{
+  ddb::DATA_FORM form = obj->getForm();
+  if (form != ddb::DF_TABLE && form != ddb::DF_VECTOR) {
+    throw std::runtime_error("<Python API Exception> only a table or a "
+      "vector converts to arrow, got " + utils::DataFormToString(form));
+  }
+  py::module pyarrow = py::module::import("pyarrow");
+  ArrowArray array = ArrowArray();
+  ArrowSchema schema = ArrowSchema();
+  ArrowGuard guard{&array, &schema};
+  {
+    py::gil_scoped_release release;
+    if (form == ddb::DF_TABLE) {
+      exportTable(obj, &array, &schema);
+    } else {
+      exportVector(obj, "", &array, &schema);
+    }
+  }
+  if (form == ddb::DF_VECTOR) {
+    return pyarrow.attr("Array").attr("_import_from_c")(
+      address(&array), address(&schema));
+  }
+  py::object batch = pyarrow.attr("RecordBatch").attr("_import_from_c")(
+    address(&array), address(&schema));
+  py::list batches;
+  batches.append(batch);
+  return pyarrow.attr("Table").attr("from_batches")(batches);
+}
+
+bool isArrow(py::object obj)
+{
+  py::object modules = py::module::import("sys").attr("modules");
+  PyObject *pyarrow = PyDict_GetItemString(modules.ptr(), "pyarrow");
+  if (pyarrow == nullptr) {
+    return false;
+  }
+  py::handle module(pyarrow);
+  return py::isinstance(obj, module.attr("Array")) ||
+    py::isinstance(obj, module.attr("RecordBatch")) ||
+    py::isinstance(obj, module.attr("Table"));
+}
+
+ddb::ConstantSP fromArrow(py::object obj)
+{
+  py::module pyarrow = py::module::import("pyarrow");
+  std::vector<std::string> names;
+  std::vector<ddb::VectorSP> columns;
+  if (py::isinstance(obj, pyarrow.attr("RecordBatch"))) {
+    importBatch(obj, names, columns);
+    return createTable(names, columns);
+  }
+  if (py::isinstance(obj, pyarrow.attr("Table"))) {
+    py::list batches = obj.attr("to_batches")();
+    if (batches.size() == 0) {
+      // an empty table still has typed columns
+      py::object schema = obj.attr("schema");
+      py::list arrays;
+      for (auto field : schema) {
+        arrays.append(pyarrow.attr("array")(
+          py::list(), py::arg("type") = field.attr("type")));
+      }
+      batches.append(pyarrow.attr("RecordBatch").attr("from_arrays")(
+        arrays, py::arg("schema") = schema));
+    }
+    for (auto batch : batches) {
+      importBatch(py::reinterpret_borrow<py::object>(batch), names, columns);
+    }
+    return createTable(names, columns);
+  }
+  ArrowArray array = ArrowArray();
+  ArrowSchema schema = ArrowSchema();
+  ArrowGuard guard{&array, &schema};
+  obj.attr("_export_to_c")(address(&array), address(&schema));
+  py::gil_scoped_release release;
+  return importVector(ArrowColumn{&array, &schema, 0, array.length});
+}
+
+}  // namespace arrow
+
+}  // namespace pydolphindb
@@ -0,0 +1,93 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PYDOLPHINDB_ARROW_H_
+#define PYDOLPHINDB_ARROW_H_
+
+#include <pybind11/pybind11.h>
+
+#include <cstdint>
+
+#include <DolphinDB.h>
+
+#include "Utils.h"
+
+// Arrow C Data Interface, declared here so no Arrow library is needed to
+// build, see https://arrow.apache.org/docs/format/CDataInterface.html
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+  const char *format;
+  const char *name;
+  const char *metadata;
+  int64_t flags;
+  int64_t n_children;
+  struct ArrowSchema **children;
+  struct ArrowSchema *dictionary;
+  void (*release)(struct ArrowSchema*);
+  void *private_data;
+};
+
+struct ArrowArray {
+  int64_t length;
+  int64_t null_count;
+  int64_t offset;
+  int64_t n_buffers;
+  int64_t n_children;
+  const void **buffers;
+  struct ArrowArray **children;
+  struct ArrowArray *dictionary;
+  void (*release)(struct ArrowArray*);
+  void *private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace pydolphindb
+{
+
+// Exchange with pyarrow through the C Data Interface. Null sentinels map to
+// validity bitmaps, STRING to utf8 and SYMBOL to dictionary arrays.
+namespace arrow
+{
+
+// a table as pyarrow.Table, a vector as pyarrow.Array; fixed width buffers
+// are shared with the DolphinDB vectors instead of copied
+py::object toArrow(ddb::ConstantSP obj);
+
+// whether obj is a pyarrow.Array, RecordBatch or Table (pyarrow is never
+// imported by this check)
+bool isArrow(py::object obj);
+
+// a pyarrow.Array as a vector, a RecordBatch or Table as a table
+ddb::ConstantSP fromArrow(py::object obj);
+
+}  // namespace arrow
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_ARROW_H_
@@ -0,0 +1,368 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <iostream>
+
+#include "AsyncWriter.h"
+
+namespace pydolphindb
+{
+
+AsyncWriter::AsyncWriter(
+  const std::string &host,
+  int port,
+  const std::string &userId,
+  const std::string &password,
+  const std::string &tableName,
+  int batchSize,
+  int throttle,
+  py::object onError)
+  : funcName_("tableInsert{" + tableName + "}")
+  , columnTypes_()
+  , batchSize_(0)
+  , throttle_(throttle)
+  , onError_(onError)
+  , dbConnection_()
+  , queue_()
+  , pending_(0)
+  , mutex_()
+  , wake_()
+  , drained_()
+  , signaled_(false)
+  , stopped_(false)
+  , flushing_(0)
+  , failed_(false)
+  , error_()
+  , thread_()
+{
+  if (batchSize <= 0 || throttle <= 0) {
+    throw std::runtime_error("<Python API Exception> asyncWriter: "
+      "batchSize and throttle must be positive");
+  }
+  batchSize_ = static_cast<size_t>(batchSize);
+  {
+    py::gil_scoped_release release;
+    bool isSuccess = false;
+    try {
+      isSuccess = dbConnection_.connect(host, port, userId, password);
+    } catch (std::exception &ex) {
+      throw std::runtime_error(std::string("<Server Exception> connect: ") +
+        ex.what());
+    }
+    if (!isSuccess) {
+      throw std::runtime_error("<Server Exception> connect: failed to "
+        "connect to " + host + ":" + std::to_string(port));
+    }
+    ddb::TableSP colDefs;
+    try {
+      colDefs = dbConnection_.run("schema(" + tableName + ").colDefs");
+    } catch (std::exception &ex) {
+      throw std::runtime_error(std::string("<Server Exception> in "
+        "asyncWriter: ") + ex.what());
+    }
+    ddb::VectorSP typeInts = colDefs->getColumn("typeInt");
+    for (int i = 0; i < typeInts->size(); ++i) {
+      columnTypes_.push_back(
+        static_cast<ddb::DATA_TYPE>(typeInts->getInt(i)));
+    }
+  }
+  thread_ = std::thread(&AsyncWriter::loop, this);
+}
+
+AsyncWriter::~AsyncWriter()
+{
+  {
+    // onError may be called until the writer thread exits
+    py::gil_scoped_release release;
+    shutdown();
+  }
+  if (!error_.empty()) {
+    std::cout << "<Server Exception> in asyncWriter: " << error_ << std::endl;
+  }
+}
+
+void AsyncWriter::insert(py::args row)
+{
+  Item item;
+  item.values.reserve(row.size());
+  for (auto it = row.begin(); it != row.end(); ++it) {
+    item.values.push_back(
+      utils::toDolphinDB(py::reinterpret_borrow<py::object>(*it)));
+  }
+  item.rows = 1;
+  push(std::move(item));
+}
+
+void AsyncWriter::insertBatch(py::object dataframe)
+{
+  if (!py::isinstance(dataframe, pytype::pddataframe_)) {
+    throw std::runtime_error("<Python API Exception> insertBatch: "
+      "a pandas.DataFrame is required");
+  }
+  std::vector<ddb::VectorSP> columns;
+  ddb::TableSP tbl = utils::dataFrameToDolphinDB(dataframe, columns);
+  Item item;
+  item.values.assign(columns.begin(), columns.end());
+  item.rows = tbl->size();
+  if (item.rows == 0) {
+    return;
+  }
+  push(std::move(item));
+}
+
+void AsyncWriter::push(Item &&item)
+{
+  size_t rows = item.rows;
+  if (stopped_) {
+    throw std::runtime_error("<Python API Exception> insert: "
+      "asyncWriter is closed");
+  }
+  if (failed_) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    checkError("insert");
+  }
+  // counted before stopped_ is checked again: either the writer thread,
+  // which reads stopped_ before pending_, waits for these rows, or this
+  // push sees stopped_ and takes them back
+  size_t before = pending_.fetch_add(rows);
+  if (stopped_) {
+    done(rows);
+    throw std::runtime_error("<Python API Exception> insert: "
+      "asyncWriter is closed");
+  }
+  queue_.push(std::move(item));
+  // the writer sleeps until the throttle expires, wake it only when a
+  // batch starts or fills up
+  if (before == 0 || (before < batchSize_ && before + rows >= batchSize_)) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    signaled_ = true;
+    wake_.notify_one();
+  }
+}
+
+void AsyncWriter::flush()
+{
+  std::string error;
+  {
+    py::gil_scoped_release release;
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++flushing_;
+    signaled_ = true;
+    wake_.notify_one();
+    drained_.wait(lock, [this] { return pending_ == 0 || stopped_; });
+    --flushing_;
+    error.swap(error_);
+    failed_ = false;
+  }
+  if (!error.empty()) {
+    throw std::runtime_error("<Server Exception> in flush: " + error);
+  }
+}
+
+size_t AsyncWriter::pending() const
+{
+  return pending_;
+}
+
+void AsyncWriter::close()
+{
+  {
+    py::gil_scoped_release release;
+    shutdown();
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  checkError("close");
+}
+
+void AsyncWriter::shutdown()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_.exchange(true)) {
+      return;
+    }
+    signaled_ = true;
+    wake_.notify_one();
+  }
+  // the writer thread writes what is left before it exits
+  thread_.join();
+  dbConnection_.close();
+}
+
+void AsyncWriter::checkError(const char *method)
+{
+  if (!error_.empty()) {
+    std::string error;
+    error.swap(error_);
+    failed_ = false;
+    throw std::runtime_error(std::string("<Server Exception> in ") + method +
+      ": " + error);
+  }
+}
+
+void AsyncWriter::loop()
+{
+  std::vector<ddb::VectorSP> columns;
+  size_t rows = 0;
+  auto since = std::chrono::steady_clock::now();
+  Item item;
+  while (true) {
+    while (queue_.pop(item)) {
+      std::string error;
+      if (!append(columns, item, error)) {
+        done(item.rows);
+        report(error);
+        continue;
+      }
+      if (rows == 0) {
+        since = std::chrono::steady_clock::now();
+      }
+      rows += item.rows;
+      item.values.clear();
+    }
+    auto now = std::chrono::steady_clock::now();
+    // stopped_ is read before pending_, see push
+    bool closing = stopped_;
+    bool hurried = closing || flushing_ != 0;
+    if (rows != 0 &&
+        (rows >= batchSize_ || now >= since + throttle_ || hurried)) {
+      write(columns, rows);
+      rows = 0;
+      continue;
+    }
+    if (closing && pending_ == 0) {
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (signaled_) {
+      signaled_ = false;
+      continue;
+    }
+    // a push may be half done while closing or flushing, look again soon
+    auto deadline = rows != 0 ? since + throttle_ : now + throttle_;
+    if (stopped_ || flushing_ != 0) {
+      deadline = now + std::chrono::milliseconds(1);
+    }
+    wake_.wait_until(lock, deadline, [this] { return signaled_; });
+    signaled_ = false;
+  }
+}
+
+bool AsyncWriter::append(
+  std::vector<ddb::VectorSP> &columns,
+  const Item &item,
+  std::string &error)
+{
+  if (columns.empty()) {
+    for (auto type : columnTypes_) {
+      columns.push_back(ddb::Util::createVector(
+        type, 0, static_cast<ddb::INDEX>(batchSize_)));
+    }
+  }
+  if (columns.size() != item.values.size()) {
+    error = "got " + std::to_string(item.values.size()) +
+      " values, expected " + std::to_string(columns.size());
+    return false;
+  }
+  for (size_t i = 0; i < columns.size(); ++i) {
+    ddb::ConstantSP value = item.values[i];
+    bool appended = false;
+    try {
+      // append converts between numeric types by value, but would copy
+      // the raw count of another temporal unit
+      if (value->getType() != columnTypes_[i] &&
+          value->getCategory() == ddb::TEMPORAL) {
+        value = value->castTemporal(columnTypes_[i]);
+      }
+      // a scalar appends one element, a vector all of them
+      appended = columns[i]->append(value);
+    } catch (std::exception &ex) {
+      error = ex.what();
+    }
+    if (!appended) {
+      if (error.empty()) {
+        error = "failed to append a value to column " + std::to_string(i);
+      }
+      // keep the columns aligned
+      for (size_t j = 0; j < i; ++j) {
+        columns[j]->resize(columns[j]->size() - item.rows);
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+void AsyncWriter::write(std::vector<ddb::VectorSP> &columns, size_t rows)
+{
+  std::string error;
+  try {
+    std::vector<ddb::ConstantSP> args(columns.begin(), columns.end());
+    dbConnection_.run(funcName_, args);
+  } catch (std::exception &ex) {
+    error = ex.what();
+  }
+  // the vectors were serialized, refill them in place; a SYMBOL vector is
+  // replaced, its symbol base would otherwise keep growing
+  for (auto &column : columns) {
+    if (column->getType() == ddb::DT_SYMBOL) {
+      column = ddb::Util::createVector(
+        ddb::DT_SYMBOL, 0, static_cast<ddb::INDEX>(batchSize_));
+      continue;
+    }
+    column->resize(0);
+    column->setNullFlag(false);
+  }
+  done(rows);
+  if (!error.empty()) {
+    report(error);
+  }
+}
+
+void AsyncWriter::done(size_t rows)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  pending_ -= rows;
+  drained_.notify_all();
+}
+
+void AsyncWriter::report(const std::string &error)
+{
+  if (onError_.is_none()) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (error_.empty()) {
+      error_ = error;
+      failed_ = true;
+    }
+    return;
+  }
+  py::gil_scoped_acquire acquire;
+  try {
+    onError_(py::str(error));
+  } catch (std::exception &ex) {
+    std::cout << "<Python API Exception> asyncWriter onError: "
+      << ex.what() << std::endl;
+  }
+}
+
+}  // namespace pydolphindb
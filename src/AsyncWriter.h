@@ -0,0 +1,124 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PYDOLPHINDB_ASYNCWRITER_H_
+#define PYDOLPHINDB_ASYNCWRITER_H_
+
+#include <pybind11/pybind11.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <DolphinDB.h>
+
+#include "Utils.h"
+#include "MPSCQueue.h"
+
+namespace pydolphindb
+{
+
+namespace py = pybind11;
+namespace ddb = dolphindb;
+
+// Buffers rows for one table and inserts them from a background thread.
+// Producers only convert their values and push them onto a lock-free queue,
+// the writer thread appends them to column vectors without the GIL and calls
+// tableInsert once batchSize rows are buffered or throttle milliseconds after
+// the first one. The column types come from the schema of the table, read
+// once at construction, and the buffered values are converted to them.
+// A failed insert drops its rows and is passed to onError (with the GIL
+// held) or, without a callback, raised by the next call.
+class AsyncWriter {
+ public:
+  AsyncWriter(
+    const std::string &host,
+    int port,
+    const std::string &userId,
+    const std::string &password,
+    const std::string &tableName,
+    int batchSize,
+    int throttle,
+    py::object onError);
+  ~AsyncWriter();
+  // one row, a value per column
+  void insert(py::args row);
+  // a DataFrame with the columns of the table
+  void insertBatch(py::object dataframe);
+  // wait until every queued row is written
+  void flush();
+  // rows queued, buffered or being written
+  size_t pending() const;
+  void close();
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(AsyncWriter);
+  struct Item {
+    Item() : values(), rows(0) {}
+    // scalars for a row, vectors for a batch
+    std::vector<ddb::ConstantSP> values;
+    size_t rows;
+  };
+  void push(Item &&item);
+  void loop();
+  bool append(
+    std::vector<ddb::VectorSP> &columns,
+    const Item &item,
+    std::string &error);
+  void write(std::vector<ddb::VectorSP> &columns, size_t rows);
+  // rows leave pending_, written or dropped
+  void done(size_t rows);
+  void report(const std::string &error);
+  void shutdown();
+  // throw and clear the stored error, requires mutex_
+  void checkError(const char *method);
+  std::string funcName_;
+  // of the buffered columns, as in the schema
+  std::vector<ddb::DATA_TYPE> columnTypes_;
+  size_t batchSize_;
+  std::chrono::milliseconds throttle_;
+  py::object onError_;
+  ddb::DBConnection dbConnection_;
+  MPSCQueue<Item> queue_;
+  std::atomic<size_t> pending_;
+  std::mutex mutex_;
+  // wakes the writer thread
+  std::condition_variable wake_;
+  // signaled after every write
+  std::condition_variable drained_;
+  bool signaled_;
+  // read by producers and the writer thread without mutex_
+  std::atomic<bool> stopped_;
+  std::atomic<size_t> flushing_;
+  // error_ is set, lets push skip mutex_ otherwise
+  std::atomic<bool> failed_;
+  std::string error_;
+  std::thread thread_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_ASYNCWRITER_H_
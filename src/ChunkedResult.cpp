@@ -0,0 +1,144 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <iostream>
+
+#include "ChunkedResult.h"
+
+namespace pydolphindb
+{
+
+ChunkedResult::ChunkedResult(
+  std::mutex &mutex,
+  bool &reading,
+  const uint64_t &sessionGeneration,
+  uint64_t generation,
+  ddb::ConstantSP result,
+  const utils::ConvertOptions &options,
+  bool reuseBuffers)
+  : mutex_(mutex)
+  , reading_(reading)
+  , sessionGeneration_(sessionGeneration)
+  , generation_(generation)
+  , reader_()
+  , single_()
+  , options_(options)
+  , reuseBuffers_(reuseBuffers)
+  , buffers_()
+{
+  if (!result.isNull() && result->getForm() == ddb::DF_SYSOBJ) {
+    reader_ = result;
+    reading_ = true;
+  } else {
+    single_ = result;
+  }
+}
+
+ChunkedResult::~ChunkedResult()
+{
+  try {
+    close();
+  } catch (std::exception &ex) {
+    std::cout << "<Python API Exception> skipping a chunked result: "
+      << ex.what() << std::endl;
+  }
+}
+
+py::object ChunkedResult::next()
+{
+  ddb::ConstantSP chunk;
+  if (!single_.isNull()) {
+    chunk = single_;
+    single_ = ddb::ConstantSP();
+    return convert(chunk);
+  }
+  if (reader_.isNull()) {
+    throw py::stop_iteration();
+  }
+  bool stale = false;
+  try {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (sessionGeneration_ != generation_) {
+      stale = true;
+    } else if (reader_->hasNext()) {
+      chunk = reader_->read();
+    }
+  } catch (std::exception &ex) {
+    finish();
+    throw std::runtime_error(
+      std::string("<Server Exception> in runChunked: ") + ex.what());
+  }
+  if (stale) {
+    reader_ = ddb::BlockReaderSP();
+    throw std::runtime_error("<Python API Exception> runChunked: the session "
+      "was closed or reconnected");
+  }
+  if (chunk.isNull()) {
+    finish();
+    throw py::stop_iteration();
+  }
+  return convert(chunk);
+}
+
+void ChunkedResult::close()
+{
+  single_ = ddb::ConstantSP();
+  if (reader_.isNull()) {
+    return;
+  }
+  ddb::BlockReaderSP reader = reader_;
+  reader_ = ddb::BlockReaderSP();
+  // after close or connect the blocks left went away with the old
+  // connection, and reading_ may belong to a newer result already
+  bool current = true;
+  try {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(mutex_);
+    current = sessionGeneration_ == generation_;
+    if (current) {
+      reader->skipAll();
+    }
+  } catch (...) {
+    reading_ = false;
+    throw;
+  }
+  if (current) {
+    reading_ = false;
+  }
+}
+
+py::object ChunkedResult::convert(ddb::ConstantSP chunk)
+{
+  if (!reuseBuffers_) {
+    return utils::toPython(chunk, options_);
+  }
+  return utils::toPythonInto(chunk, buffers_, options_);
+}
+
+void ChunkedResult::finish()
+{
+  reader_ = ddb::BlockReaderSP();
+  reading_ = false;
+}
+
+}  // namespace pydolphindb
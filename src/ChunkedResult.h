@@ -0,0 +1,84 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PYDOLPHINDB_CHUNKEDRESULT_H_
+#define PYDOLPHINDB_CHUNKEDRESULT_H_
+
+#include <pybind11/pybind11.h>
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <DolphinDB.h>
+
+#include "Utils.h"
+
+namespace pydolphindb
+{
+
+namespace py = pybind11;
+namespace ddb = dolphindb;
+
+// Python iterator over a table result fetched block by block (the server's
+// fetchSize), so only one block is held by the client at a time. With
+// reuseBuffers the numpy buffers of fixed width columns are overwritten by
+// the next block instead of allocated again, a block must then be consumed
+// before the iteration continues. The connection is busy until the result
+// is exhausted or closed; once the session is closed or reconnected the
+// iterator fails instead of reading from the new connection.
+class ChunkedResult {
+ public:
+  // mutex, reading and sessionGeneration belong to the session and outlive
+  // the iterator, generation is the one the result was fetched under
+  ChunkedResult(
+    std::mutex &mutex,
+    bool &reading,
+    const uint64_t &sessionGeneration,
+    uint64_t generation,
+    ddb::ConstantSP result,
+    const utils::ConvertOptions &options,
+    bool reuseBuffers);
+  ~ChunkedResult();
+  // the next block converted like a run result, raises StopIteration
+  py::object next();
+  // skip the blocks left on the server
+  void close();
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(ChunkedResult);
+  py::object convert(ddb::ConstantSP chunk);
+  void finish();
+  std::mutex &mutex_;
+  bool &reading_;
+  const uint64_t &sessionGeneration_;
+  uint64_t generation_;
+  ddb::BlockReaderSP reader_;
+  // a result small enough to arrive in one piece
+  ddb::ConstantSP single_;
+  utils::ConvertOptions options_;
+  bool reuseBuffers_;
+  std::vector<py::object> buffers_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_CHUNKEDRESULT_H_
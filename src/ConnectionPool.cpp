@@ -0,0 +1,239 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "ConnectionPool.h"
+
+namespace pydolphindb
+{
+
+ConnectionPool::Lease::Lease(ConnectionPool &pool)
+  : pool_(pool)
+  , conn_(pool.acquire())
+{
+
+}
+
+ConnectionPool::Lease::~Lease()
+{
+  pool_.release(conn_);
+}
+
+ConnectionPool::ConnectionPool(
+  const std::string &host,
+  int port,
+  int size,
+  const std::string &userId,
+  const std::string &password)
+  : mutex_()
+  , cond_()
+  , host_(host)
+  , port_(port)
+  , userId_(userId)
+  , password_(password)
+  , closed_(false)
+  , connections_()
+  , idle_()
+{
+  if (size <= 0) {
+    throw std::runtime_error("<Python API Exception> connectionPool: "
+      "pool size must be positive");
+  }
+  py::gil_scoped_release release;
+  for (int i = 0; i < size; ++i) {
+    connections_.emplace_back(new Connection());
+    bool isSuccess = false;
+    try {
+      isSuccess = connections_.back()->dbConnection.connect(
+        host_, port_, userId_, password_);
+    } catch (std::exception &ex) {
+      throw std::runtime_error(std::string("<Server Exception> connect: ") +
+        ex.what());
+    }
+    if (!isSuccess) {
+      throw std::runtime_error("<Server Exception> connect: failed to "
+        "connect to " + host_ + ":" + std::to_string(port_));
+    }
+    idle_.push_back(connections_.back().get());
+  }
+}
+
+ConnectionPool::~ConnectionPool()
+{
+  shutdown();
+}
+
+ConnectionPool::Connection *ConnectionPool::acquire()
+{
+  Connection *conn = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return closed_ || !idle_.empty(); });
+    if (closed_) {
+      throw std::runtime_error("<Python API Exception> connectionPool: "
+        "pool is closed");
+    }
+    conn = idle_.back();
+    idle_.pop_back();
+  }
+  if (conn->broken) {
+    bool isSuccess = false;
+    try {
+      conn->dbConnection.close();
+      isSuccess = conn->dbConnection.connect(
+        host_, port_, userId_, password_);
+    } catch (std::exception &ex) {
+      release(conn);
+      throw std::runtime_error(std::string("<Server Exception> reconnect: ") +
+        ex.what());
+    }
+    if (!isSuccess) {
+      release(conn);
+      throw std::runtime_error("<Server Exception> reconnect: failed to "
+        "connect to " + host_ + ":" + std::to_string(port_));
+    }
+    conn->broken = false;
+  }
+  return conn;
+}
+
+void ConnectionPool::release(Connection *conn)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (closed_) {
+    conn->dbConnection.close();
+    return;
+  }
+  idle_.push_back(conn);
+  cond_.notify_one();
+}
+
+void ConnectionPool::close()
+{
+  py::gil_scoped_release release;
+  shutdown();
+}
+
+void ConnectionPool::shutdown()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (closed_) {
+    return;
+  }
+  closed_ = true;
+  for (auto conn : idle_) {
+    conn->dbConnection.close();
+  }
+  idle_.clear();
+  cond_.notify_all();
+}
+
+int ConnectionPool::size() const
+{
+  return static_cast<int>(connections_.size());
+}
+
+void ConnectionPool::upload(
+  std::vector<std::string> &names,
+  std::vector<ddb::ConstantSP> &objs)
+{
+  Lease lease(*this);
+  try {
+    lease.get().upload(names, objs);
+  } catch (std::exception &ex) {
+    lease.markBroken();
+    throw std::runtime_error(std::string("<Server Exception> in upload: ") +
+      ex.what());
+  }
+}
+
+ddb::ConstantSP ConnectionPool::execute(const std::string &script)
+{
+  Lease lease(*this);
+  try {
+    return lease.get().run(script);
+  } catch (std::exception &ex) {
+    lease.markBroken();
+    throw std::runtime_error(std::string("<Server Exception> in run: ") +
+      ex.what());
+  }
+}
+
+ddb::ConstantSP ConnectionPool::execute(
+  const std::string &funcName,
+  std::vector<ddb::ConstantSP> &args)
+{
+  Lease lease(*this);
+  try {
+    return lease.get().run(funcName, args);
+  } catch (std::exception &ex) {
+    lease.markBroken();
+    throw std::runtime_error(std::string("<Server Exception> in call: ") +
+      ex.what());
+  }
+}
+
+void ConnectionPool::upload(py::dict namedObjects)
+{
+  std::vector<std::string> names;
+  std::vector<ddb::ConstantSP> objs;
+  for (auto it = namedObjects.begin(); it != namedObjects.end(); ++it) {
+    if (!py::isinstance(it->first, pytype::pystr_) &&
+      !py::isinstance(it->first, pytype::pybytes_)) {
+      throw std::runtime_error("<Python API Exception> upload: non-string key"
+        "in upload dictionary is not allowed");
+    }
+    names.push_back(it->first.cast<std::string>());
+    objs.push_back(
+      utils::toDolphinDB(py::reinterpret_borrow<py::object>(it->second)));
+  }
+  py::gil_scoped_release release;
+  upload(names, objs);
+}
+
+py::object ConnectionPool::run(const std::string &script)
+{
+  ddb::ConstantSP result;
+  {
+    py::gil_scoped_release release;
+    result = execute(script);
+  }
+  return utils::toPython(result);
+}
+
+py::object ConnectionPool::run(
+  const std::string &funcName,
+  py::args args)
+{
+  std::vector<ddb::ConstantSP> ddbArgs;
+  for (auto it = args.begin(); it != args.end(); ++it) {
+    ddbArgs.push_back(
+      utils::toDolphinDB(py::reinterpret_borrow<py::object>(*it)));
+  }
+  ddb::ConstantSP result;
+  {
+    py::gil_scoped_release release;
+    result = execute(funcName, ddbArgs);
+  }
+  return utils::toPython(result);
+}
+
+}  // namespace pydolphindb
@@ -0,0 +1,107 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PYDOLPHINDB_CONNECTIONPOOL_H_
+#define PYDOLPHINDB_CONNECTIONPOOL_H_
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+#include <DolphinDB.h>
+
+#include "Utils.h"
+
+namespace pydolphindb
+{
+
+namespace py = pybind11;
+namespace ddb = dolphindb;
+
+// A fixed set of DBConnections to the same server. Every call checks out one
+// idle connection for its duration, so concurrent callers run in parallel.
+// A connection that raised during a call is marked broken and reconnected
+// with the stored credentials on its next checkout.
+class ConnectionPool {
+ public:
+  ConnectionPool(
+    const std::string &host,
+    int port,
+    int size,
+    const std::string &userId,
+    const std::string &password);
+  ~ConnectionPool();
+  void upload(py::dict namedObjects);
+  py::object run(const std::string &script);
+  py::object run(const std::string &funcName, py::args args);
+  void close();
+  int size() const;
+
+  // native interfaces, the caller must not hold the GIL
+  void upload(
+    std::vector<std::string> &names,
+    std::vector<ddb::ConstantSP> &objs);
+  ddb::ConstantSP execute(const std::string &script);
+  ddb::ConstantSP execute(
+    const std::string &funcName,
+    std::vector<ddb::ConstantSP> &args);
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(ConnectionPool);
+  struct Connection {
+    Connection() : dbConnection(), broken(false) {}
+    ddb::DBConnection dbConnection;
+    bool broken;
+  };
+  // RAII checkout of one idle connection
+  class Lease {
+   public:
+    explicit Lease(ConnectionPool &pool);
+    ~Lease();
+    ddb::DBConnection &get() { return conn_->dbConnection; }
+    void markBroken() { conn_->broken = true; }
+   private:
+    DISALLOW_COPY_MOVE_AND_ASSIGN(Lease);
+    ConnectionPool &pool_;
+    Connection *conn_;
+  };
+  Connection *acquire();
+  void release(Connection *conn);
+  void shutdown();
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::string host_;
+  int port_;
+  std::string userId_;
+  std::string password_;
+  bool closed_;
+  std::vector<std::unique_ptr<Connection>> connections_;
+  std::vector<Connection*> idle_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_CONNECTIONPOOL_H_
@@ -0,0 +1,586 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include <DolphinDB.h>
+
+#include "Kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+  defined(__SSE2__)
+#define PYDOLPHINDB_SSE2
+#include <immintrin.h>
+#if defined(__clang__) || __GNUC__ > 4 || \
+  (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)
+#define PYDOLPHINDB_AVX2
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace pydolphindb
+{
+
+namespace ddb = dolphindb;
+
+namespace kernels
+{
+
+namespace
+{
+
+const double kNan = std::numeric_limits<double>::quiet_NaN();
+
+template <typename T, typename S>
+void scalarNullToNan(const T *src, double *dst, size_t len, S null)
+{
+  for (size_t i = 0; i < len; ++i) {
+    S v = static_cast<S>(src[i]);
+    dst[i] = v == null ? kNan : static_cast<double>(v);
+  }
+}
+
+template <typename T>
+size_t scalarNanToNull(const T *src, T *dst, size_t len, T null)
+{
+  size_t nans = 0;
+  for (size_t i = 0; i < len; ++i) {
+    T v = src[i];
+    bool isNan = v != v;
+    nans += isNan;
+    dst[i] = isNan ? null : v;
+  }
+  return nans;
+}
+
+template <typename T>
+void scalarNullMask(const T *src, bool *mask, size_t len, T null)
+{
+  for (size_t i = 0; i < len; ++i) {
+    mask[i] = src[i] == null;
+  }
+}
+
+template <typename T>
+void scalarNullToZero(const T *src, T *dst, size_t len, T null)
+{
+  for (size_t i = 0; i < len; ++i) {
+    T v = src[i];
+    dst[i] = v == null ? T() : v;
+  }
+}
+
+#if defined(PYDOLPHINDB_AVX2)
+
+bool hasAvx2()
+{
+  static const bool supported = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return supported;
+}
+
+// 4 int32 lanes to 4 float64, lanes equal to null become NaN
+TARGET_AVX2 void avx2Int32x4(__m128i v, __m128i null, double *dst)
+{
+  __m256d d = _mm256_cvtepi32_pd(v);
+  __m256d m = _mm256_castsi256_pd(
+    _mm256_cvtepi32_epi64(_mm_cmpeq_epi32(v, null)));
+  _mm256_storeu_pd(dst, _mm256_blendv_pd(d, _mm256_set1_pd(kNan), m));
+}
+
+TARGET_AVX2 void avx2NullToNan(const char *src, double *dst, size_t len)
+{
+  const __m128i null = _mm_set1_epi32(INT8_MIN);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    int32_t w;
+    std::memcpy(&w, src + i, 4);
+    avx2Int32x4(_mm_cvtepi8_epi32(_mm_cvtsi32_si128(w)), null, dst + i);
+  }
+  scalarNullToNan(src + i, dst + i, len - i, static_cast<int8_t>(INT8_MIN));
+}
+
+TARGET_AVX2 void avx2NullToNan(const short *src, double *dst, size_t len)
+{
+  const __m128i null = _mm_set1_epi32(INT16_MIN);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    avx2Int32x4(_mm_cvtepi16_epi32(v), null, dst + i);
+  }
+  scalarNullToNan(src + i, dst + i, len - i, static_cast<short>(INT16_MIN));
+}
+
+TARGET_AVX2 void avx2NullToNan(const int *src, double *dst, size_t len)
+{
+  const __m128i null = _mm_set1_epi32(INT32_MIN);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    avx2Int32x4(v, null, dst + i);
+  }
+  scalarNullToNan(src + i, dst + i, len - i, static_cast<int>(INT32_MIN));
+}
+
+TARGET_AVX2 void avx2NullToNan(const float *src, double *dst, size_t len)
+{
+  const __m128 null = _mm_set1_ps(ddb::FLT_NMIN);
+  const __m256d nan = _mm256_set1_pd(kNan);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128 f = _mm_loadu_ps(src + i);
+    __m256d m = _mm256_castsi256_pd(
+      _mm256_cvtepi32_epi64(_mm_castps_si128(_mm_cmpeq_ps(f, null))));
+    _mm256_storeu_pd(dst + i, _mm256_blendv_pd(_mm256_cvtps_pd(f), nan, m));
+  }
+  scalarNullToNan(src + i, dst + i, len - i, ddb::FLT_NMIN);
+}
+
+TARGET_AVX2 void avx2NullToNan(const double *src, double *dst, size_t len)
+{
+  const __m256d null = _mm256_set1_pd(ddb::DBL_NMIN);
+  const __m256d nan = _mm256_set1_pd(kNan);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m256d d = _mm256_loadu_pd(src + i);
+    __m256d m = _mm256_cmp_pd(d, null, _CMP_EQ_OQ);
+    _mm256_storeu_pd(dst + i, _mm256_blendv_pd(d, nan, m));
+  }
+  scalarNullToNan(src + i, dst + i, len - i, ddb::DBL_NMIN);
+}
+
+TARGET_AVX2 size_t avx2NanToNull(const float *src, float *dst, size_t len)
+{
+  const __m256 null = _mm256_set1_ps(ddb::FLT_NMIN);
+  size_t nans = 0;
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    __m256 f = _mm256_loadu_ps(src + i);
+    __m256 m = _mm256_cmp_ps(f, f, _CMP_UNORD_Q);
+    nans += __builtin_popcount(_mm256_movemask_ps(m));
+    _mm256_storeu_ps(dst + i, _mm256_blendv_ps(f, null, m));
+  }
+  return nans + scalarNanToNull(src + i, dst + i, len - i, ddb::FLT_NMIN);
+}
+
+TARGET_AVX2 size_t avx2NanToNull(const double *src, double *dst, size_t len)
+{
+  const __m256d null = _mm256_set1_pd(ddb::DBL_NMIN);
+  size_t nans = 0;
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m256d d = _mm256_loadu_pd(src + i);
+    __m256d m = _mm256_cmp_pd(d, d, _CMP_UNORD_Q);
+    nans += __builtin_popcount(_mm256_movemask_pd(m));
+    _mm256_storeu_pd(dst + i, _mm256_blendv_pd(d, null, m));
+  }
+  return nans + scalarNanToNull(src + i, dst + i, len - i, ddb::DBL_NMIN);
+}
+
+#endif  // PYDOLPHINDB_AVX2
+
+#if defined(PYDOLPHINDB_SSE2)
+
+inline __m128d sse2Select(__m128d mask, __m128d a, __m128d b)
+{
+  return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+// 4 int32 lanes to 4 float64, lanes equal to null become NaN
+inline void sse2Int32x4(__m128i v, __m128i null, double *dst)
+{
+  const __m128d nan = _mm_set1_pd(kNan);
+  __m128i m = _mm_cmpeq_epi32(v, null);
+  __m128d lo = _mm_cvtepi32_pd(v);
+  __m128d hi = _mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  _mm_storeu_pd(dst,
+    sse2Select(_mm_castsi128_pd(_mm_unpacklo_epi32(m, m)), nan, lo));
+  _mm_storeu_pd(dst + 2,
+    sse2Select(_mm_castsi128_pd(_mm_unpackhi_epi32(m, m)), nan, hi));
+}
+
+void sse2NullToNan(const char *src, double *dst, size_t len)
+{
+  const __m128i null = _mm_set1_epi32(INT8_MIN);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    int32_t w;
+    std::memcpy(&w, src + i, 4);
+    __m128i v = _mm_cvtsi32_si128(w);
+    v = _mm_unpacklo_epi8(v, v);
+    v = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 24);
+    sse2Int32x4(v, null, dst + i);
+  }
+  scalarNullToNan(src + i, dst + i, len - i, static_cast<int8_t>(INT8_MIN));
+}
+
+void sse2NullToNan(const short *src, double *dst, size_t len)
+{
+  const __m128i null = _mm_set1_epi32(INT16_MIN);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i));
+    sse2Int32x4(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), null, dst + i);
+  }
+  scalarNullToNan(src + i, dst + i, len - i, static_cast<short>(INT16_MIN));
+}
+
+void sse2NullToNan(const int *src, double *dst, size_t len)
+{
+  const __m128i null = _mm_set1_epi32(INT32_MIN);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    sse2Int32x4(v, null, dst + i);
+  }
+  scalarNullToNan(src + i, dst + i, len - i, static_cast<int>(INT32_MIN));
+}
+
+void sse2NullToNan(const float *src, double *dst, size_t len)
+{
+  const __m128 null = _mm_set1_ps(ddb::FLT_NMIN);
+  const __m128d nan = _mm_set1_pd(kNan);
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128 f = _mm_loadu_ps(src + i);
+    __m128i m = _mm_castps_si128(_mm_cmpeq_ps(f, null));
+    __m128d lo = _mm_cvtps_pd(f);
+    __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(f, f));
+    _mm_storeu_pd(dst + i,
+      sse2Select(_mm_castsi128_pd(_mm_unpacklo_epi32(m, m)), nan, lo));
+    _mm_storeu_pd(dst + i + 2,
+      sse2Select(_mm_castsi128_pd(_mm_unpackhi_epi32(m, m)), nan, hi));
+  }
+  scalarNullToNan(src + i, dst + i, len - i, ddb::FLT_NMIN);
+}
+
+void sse2NullToNan(const double *src, double *dst, size_t len)
+{
+  const __m128d null = _mm_set1_pd(ddb::DBL_NMIN);
+  const __m128d nan = _mm_set1_pd(kNan);
+  size_t i = 0;
+  for (; i + 2 <= len; i += 2) {
+    __m128d d = _mm_loadu_pd(src + i);
+    _mm_storeu_pd(dst + i, sse2Select(_mm_cmpeq_pd(d, null), nan, d));
+  }
+  scalarNullToNan(src + i, dst + i, len - i, ddb::DBL_NMIN);
+}
+
+// lanes bitwise equal, by lane width in bytes
+inline __m128i sse2CmpEq(__m128i a, __m128i b, std::integral_constant<int, 1>)
+{
+  return _mm_cmpeq_epi8(a, b);
+}
+
+inline __m128i sse2CmpEq(__m128i a, __m128i b, std::integral_constant<int, 2>)
+{
+  return _mm_cmpeq_epi16(a, b);
+}
+
+inline __m128i sse2CmpEq(__m128i a, __m128i b, std::integral_constant<int, 4>)
+{
+  return _mm_cmpeq_epi32(a, b);
+}
+
+inline __m128i sse2CmpEq(__m128i a, __m128i b, std::integral_constant<int, 8>)
+{
+  // no 64-bit compare before SSE4.1, both 32-bit halves must match
+  __m128i eq = _mm_cmpeq_epi32(a, b);
+  return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+// nulls are a single bit pattern, so clearing the matching lanes works for
+// integers and floats alike and is bound by memory bandwidth already
+template <typename T>
+void sse2NullToZero(const T *src, T *dst, size_t len, T null)
+{
+  const size_t lanes = sizeof(__m128i) / sizeof(T);
+  T pattern[lanes];
+  for (size_t i = 0; i < lanes; ++i) {
+    pattern[i] = null;
+  }
+  const __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern));
+  size_t i = 0;
+  for (; i + lanes <= len; i += lanes) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i m = sse2CmpEq(v, n, std::integral_constant<int, sizeof(T)>());
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(dst + i), _mm_andnot_si128(m, v));
+  }
+  scalarNullToZero(src + i, dst + i, len - i, null);
+}
+
+// one bit per lane out of a lane mask, by lane width in bytes
+inline int sse2LaneBits(__m128i m, std::integral_constant<int, 1>)
+{
+  return _mm_movemask_epi8(m);
+}
+
+inline int sse2LaneBits(__m128i m, std::integral_constant<int, 2>)
+{
+  return _mm_movemask_epi8(_mm_packs_epi16(m, _mm_setzero_si128()));
+}
+
+inline int sse2LaneBits(__m128i m, std::integral_constant<int, 4>)
+{
+  return _mm_movemask_ps(_mm_castsi128_ps(m));
+}
+
+inline int sse2LaneBits(__m128i m, std::integral_constant<int, 8>)
+{
+  return _mm_movemask_pd(_mm_castsi128_pd(m));
+}
+
+// the 4 bytes of a bool mask for each nibble of lane bits (little endian)
+const uint32_t kNibbleBytes[16] = {
+  0x00000000, 0x00000001, 0x00000100, 0x00000101,
+  0x00010000, 0x00010001, 0x00010100, 0x00010101,
+  0x01000000, 0x01000001, 0x01000100, 0x01000101,
+  0x01010000, 0x01010001, 0x01010100, 0x01010101
+};
+
+template <typename T>
+void sse2NullMask(const T *src, bool *mask, size_t len, T null)
+{
+  const size_t lanes = sizeof(__m128i) / sizeof(T);
+  T pattern[lanes];
+  for (size_t i = 0; i < lanes; ++i) {
+    pattern[i] = null;
+  }
+  const __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pattern));
+  size_t i = 0;
+  for (; i + lanes <= len; i += lanes) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    __m128i m = sse2CmpEq(v, n, std::integral_constant<int, sizeof(T)>());
+    int bits = sse2LaneBits(m, std::integral_constant<int, sizeof(T)>());
+    for (size_t k = 0; k < lanes; k += 4) {
+      uint32_t bytes = kNibbleBytes[(bits >> k) & 0xF];
+      std::memcpy(mask + i + k, &bytes, std::min<size_t>(4, lanes - k));
+    }
+  }
+  scalarNullMask(src + i, mask + i, len - i, null);
+}
+
+size_t sse2NanToNull(const float *src, float *dst, size_t len)
+{
+  const __m128 null = _mm_set1_ps(ddb::FLT_NMIN);
+  size_t nans = 0;
+  size_t i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128 f = _mm_loadu_ps(src + i);
+    __m128 m = _mm_cmpunord_ps(f, f);
+    nans += __builtin_popcount(_mm_movemask_ps(m));
+    _mm_storeu_ps(dst + i, _mm_or_ps(_mm_and_ps(m, null), _mm_andnot_ps(m, f)));
+  }
+  return nans + scalarNanToNull(src + i, dst + i, len - i, ddb::FLT_NMIN);
+}
+
+size_t sse2NanToNull(const double *src, double *dst, size_t len)
+{
+  const __m128d null = _mm_set1_pd(ddb::DBL_NMIN);
+  size_t nans = 0;
+  size_t i = 0;
+  for (; i + 2 <= len; i += 2) {
+    __m128d d = _mm_loadu_pd(src + i);
+    __m128d m = _mm_cmpunord_pd(d, d);
+    nans += __builtin_popcount(_mm_movemask_pd(m));
+    _mm_storeu_pd(dst + i, sse2Select(m, null, d));
+  }
+  return nans + scalarNanToNull(src + i, dst + i, len - i, ddb::DBL_NMIN);
+}
+
+#endif  // PYDOLPHINDB_SSE2
+
+}  // namespace
+
+#if defined(PYDOLPHINDB_AVX2)
+#define DISPATCH_AVX2(src, dst, len)          \
+  if (hasAvx2()) {                            \
+    avx2NullToNan(src, dst, len);             \
+    return;                                   \
+  }
+#else
+#define DISPATCH_AVX2(src, dst, len)
+#endif
+
+#if defined(PYDOLPHINDB_SSE2)
+#define DISPATCH_SSE2(src, dst, len, null)    \
+  sse2NullToNan(src, dst, len)
+#else
+#define DISPATCH_SSE2(src, dst, len, null)    \
+  scalarNullToNan(src, dst, len, null)
+#endif
+
+void nullToNan(const char *src, double *dst, size_t len)
+{
+  DISPATCH_AVX2(src, dst, len);
+  DISPATCH_SSE2(src, dst, len, static_cast<int8_t>(INT8_MIN));
+}
+
+void nullToNan(const short *src, double *dst, size_t len)
+{
+  DISPATCH_AVX2(src, dst, len);
+  DISPATCH_SSE2(src, dst, len, static_cast<short>(INT16_MIN));
+}
+
+void nullToNan(const int *src, double *dst, size_t len)
+{
+  DISPATCH_AVX2(src, dst, len);
+  DISPATCH_SSE2(src, dst, len, static_cast<int>(INT32_MIN));
+}
+
+void nullToNan(const long long *src, double *dst, size_t len)
+{
+  // no packed int64 -> float64 conversion below AVX-512
+  scalarNullToNan(src, dst, len, static_cast<long long>(INT64_MIN));
+}
+
+void nullToNan(const float *src, double *dst, size_t len)
+{
+  DISPATCH_AVX2(src, dst, len);
+  DISPATCH_SSE2(src, dst, len, ddb::FLT_NMIN);
+}
+
+void nullToNan(const double *src, double *dst, size_t len)
+{
+  DISPATCH_AVX2(src, dst, len);
+  DISPATCH_SSE2(src, dst, len, ddb::DBL_NMIN);
+}
+
+size_t nanToNull(const float *src, float *dst, size_t len)
+{
+#if defined(PYDOLPHINDB_AVX2)
+  if (hasAvx2()) {
+    return avx2NanToNull(src, dst, len);
+  }
+#endif
+#if defined(PYDOLPHINDB_SSE2)
+  return sse2NanToNull(src, dst, len);
+#else
+  return scalarNanToNull(src, dst, len, ddb::FLT_NMIN);
+#endif
+}
+
+size_t nanToNull(const double *src, double *dst, size_t len)
+{
+#if defined(PYDOLPHINDB_AVX2)
+  if (hasAvx2()) {
+    return avx2NanToNull(src, dst, len);
+  }
+#endif
+#if defined(PYDOLPHINDB_SSE2)
+  return sse2NanToNull(src, dst, len);
+#else
+  return scalarNanToNull(src, dst, len, ddb::DBL_NMIN);
+#endif
+}
+
+#if defined(PYDOLPHINDB_SSE2)
+#define DISPATCH_ZERO(src, dst, len, null)    \
+  sse2NullToZero(src, dst, len, null)
+#else
+#define DISPATCH_ZERO(src, dst, len, null)    \
+  scalarNullToZero(src, dst, len, null)
+#endif
+
+void nullToZero(const char *src, char *dst, size_t len)
+{
+  DISPATCH_ZERO(src, dst, len, static_cast<char>(INT8_MIN));
+}
+
+void nullToZero(const short *src, short *dst, size_t len)
+{
+  DISPATCH_ZERO(src, dst, len, static_cast<short>(INT16_MIN));
+}
+
+void nullToZero(const int *src, int *dst, size_t len)
+{
+  DISPATCH_ZERO(src, dst, len, static_cast<int>(INT32_MIN));
+}
+
+void nullToZero(const long long *src, long long *dst, size_t len)
+{
+  DISPATCH_ZERO(src, dst, len, static_cast<long long>(INT64_MIN));
+}
+
+void nullToZero(const float *src, float *dst, size_t len)
+{
+  DISPATCH_ZERO(src, dst, len, ddb::FLT_NMIN);
+}
+
+void nullToZero(const double *src, double *dst, size_t len)
+{
+  DISPATCH_ZERO(src, dst, len, ddb::DBL_NMIN);
+}
+
+#if defined(PYDOLPHINDB_SSE2)
+#define DISPATCH_MASK(src, mask, len, null)    \
+  sse2NullMask(src, mask, len, null)
+#else
+#define DISPATCH_MASK(src, mask, len, null)    \
+  scalarNullMask(src, mask, len, null)
+#endif
+
+void nullMask(const char *src, bool *mask, size_t len)
+{
+  DISPATCH_MASK(src, mask, len, static_cast<char>(INT8_MIN));
+}
+
+void nullMask(const short *src, bool *mask, size_t len)
+{
+  DISPATCH_MASK(src, mask, len, static_cast<short>(INT16_MIN));
+}
+
+void nullMask(const int *src, bool *mask, size_t len)
+{
+  DISPATCH_MASK(src, mask, len, static_cast<int>(INT32_MIN));
+}
+
+void nullMask(const long long *src, bool *mask, size_t len)
+{
+  DISPATCH_MASK(src, mask, len, static_cast<long long>(INT64_MIN));
+}
+
+void nullMask(const float *src, bool *mask, size_t len)
+{
+  DISPATCH_MASK(src, mask, len, ddb::FLT_NMIN);
+}
+
+void nullMask(const double *src, bool *mask, size_t len)
+{
+  DISPATCH_MASK(src, mask, len, ddb::DBL_NMIN);
+}
+
+#undef DISPATCH_AVX2
+#undef DISPATCH_SSE2
+#undef DISPATCH_ZERO
+#undef DISPATCH_MASK
+
+}  // namespace kernels
+
+}  // namespace pydolphindb
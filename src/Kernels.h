@@ -0,0 +1,72 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PYDOLPHINDB_KERNELS_H_
+#define PYDOLPHINDB_KERNELS_H_
+
+#include <cstddef>
+
+namespace pydolphindb
+{
+
+// Tight loops over raw column buffers, free of Python and of DolphinDB
+// virtual calls. On x86 the best instruction set is picked at runtime
+// (AVX2, then SSE2), other platforms use the scalar version.
+namespace kernels
+{
+
+// widen DolphinDB values to float64, null sentinels become NaN,
+// nullToNan(double) may work in place (src == dst)
+void nullToNan(const char *src, double *dst, size_t len);
+void nullToNan(const short *src, double *dst, size_t len);
+void nullToNan(const int *src, double *dst, size_t len);
+void nullToNan(const long long *src, double *dst, size_t len);
+void nullToNan(const float *src, double *dst, size_t len);
+void nullToNan(const double *src, double *dst, size_t len);
+
+// copy DolphinDB values keeping their type, null sentinels become 0,
+// may work in place (src == dst)
+void nullToZero(const char *src, char *dst, size_t len);
+void nullToZero(const short *src, short *dst, size_t len);
+void nullToZero(const int *src, int *dst, size_t len);
+void nullToZero(const long long *src, long long *dst, size_t len);
+void nullToZero(const float *src, float *dst, size_t len);
+void nullToZero(const double *src, double *dst, size_t len);
+
+// validity mask of DolphinDB values, true where the value is null
+void nullMask(const char *src, bool *mask, size_t len);
+void nullMask(const short *src, bool *mask, size_t len);
+void nullMask(const int *src, bool *mask, size_t len);
+void nullMask(const long long *src, bool *mask, size_t len);
+void nullMask(const float *src, bool *mask, size_t len);
+void nullMask(const double *src, bool *mask, size_t len);
+
+// copy values for upload, NaN becomes the DolphinDB null sentinel,
+// returns the number of NaNs replaced
+size_t nanToNull(const float *src, float *dst, size_t len);
+size_t nanToNull(const double *src, double *dst, size_t len);
+
+}  // namespace kernels
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_KERNELS_H_
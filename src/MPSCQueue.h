@@ -0,0 +1,98 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PYDOLPHINDB_MPSCQUEUE_H_
+#define PYDOLPHINDB_MPSCQUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+#include "Utils.h"
+
+namespace pydolphindb
+{
+
+// Unbounded multi-producer single-consumer queue (Dmitry Vyukov's node based
+// algorithm). push is wait-free and may be called from any thread, pop only
+// from the one consumer thread. pop may miss an element whose push is still
+// in progress, the consumer must retry later.
+template <typename T>
+class MPSCQueue {
+ public:
+  MPSCQueue()
+    : stub_()
+    , head_(&stub_)
+    , tail_(&stub_)
+  {
+
+  }
+
+  ~MPSCQueue()
+  {
+    T value;
+    while (pop(value)) {
+    }
+    if (tail_ != &stub_) {
+      delete tail_;
+    }
+  }
+
+  void push(T value)
+  {
+    Node *node = new Node(std::move(value));
+    Node *prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  bool pop(T &value)
+  {
+    Node *tail = tail_;
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    // next becomes the new stub, its value is moved out
+    value = std::move(next->value);
+    tail_ = next;
+    if (tail != &stub_) {
+      delete tail;
+    }
+    return true;
+  }
+
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(MPSCQueue);
+  struct Node {
+    Node() : next(nullptr), value() {}
+    explicit Node(T &&v) : next(nullptr), value(std::move(v)) {}
+    std::atomic<Node*> next;
+    T value;
+  };
+  Node stub_;
+  std::atomic<Node*> head_;
+  Node *tail_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_MPSCQUEUE_H_
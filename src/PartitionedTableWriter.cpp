@@ -0,0 +1,398 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <functional>
+#include <iostream>
+
+#include "PartitionedTableWriter.h"
+
+namespace pydolphindb
+{
+
+PartitionedTableWriter::PartitionedTableWriter(
+  const std::string &host,
+  int port,
+  const std::string &userId,
+  const std::string &password,
+  const std::string &dbPath,
+  const std::string &tableName,
+  const std::string &partitionColumn,
+  int threads,
+  int batchSize,
+  int throttle)
+  : mutex_()
+  , drained_()
+  , funcName_()
+  , partitionColumn_(partitionColumn)
+  , domain_()
+  , batchSize_(0)
+  , throttle_(throttle)
+  , stopped_(false)
+  , flushing_(0)
+  , error_()
+  , columnNames_()
+  , columnTypes_()
+  , queues_()
+  , pool_()
+  , workers_()
+{
+  if (threads <= 0 || batchSize <= 0 || throttle < 0) {
+    throw std::runtime_error("<Python API Exception> "
+      "partitionedTableWriter: threads and batchSize must be positive, "
+      "throttle must not be negative");
+  }
+  batchSize_ = static_cast<size_t>(batchSize);
+  if (dbPath.empty()) {
+    // a shared in-memory table
+    funcName_ = "tableInsert{" + tableName + "}";
+  } else {
+    funcName_ = "tableInsert{loadTable(\"" + dbPath + "\", \"" +
+      tableName + "\")}";
+  }
+  pool_.reset(new ConnectionPool(host, port, threads, userId, password));
+  if (!dbPath.empty()) {
+    loadDomain(dbPath, tableName);
+  }
+  for (int i = 0; i < threads; ++i) {
+    queues_.emplace_back(new Queue());
+  }
+  for (int i = 0; i < threads; ++i) {
+    workers_.emplace_back(&PartitionedTableWriter::loop, this, i);
+  }
+}
+
+PartitionedTableWriter::~PartitionedTableWriter()
+{
+  py::gil_scoped_release release;
+  shutdown();
+  if (!error_.empty()) {
+    std::cout << "<Server Exception> in partitionedTableWriter: "
+      << error_ << std::endl;
+  }
+}
+
+void PartitionedTableWriter::insert(py::object dataframe)
+{
+  if (!py::isinstance(dataframe, pytype::pddataframe_)) {
+    throw std::runtime_error("<Python API Exception> insert: "
+      "a pandas.DataFrame is required");
+  }
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_) {
+      throw std::runtime_error("<Python API Exception> insert: "
+        "partitionedTableWriter is closed");
+    }
+    checkError("insert");
+  }
+  std::vector<ddb::VectorSP> converted;
+  ddb::TableSP tbl = utils::dataFrameToDolphinDB(dataframe, converted);
+  size_t rows = tbl->size();
+  size_t columnSize = tbl->columns();
+  if (rows == 0) {
+    return;
+  }
+  size_t partition = columnSize;
+  for (size_t i = 0; i < columnSize; ++i) {
+    if (tbl->getColumnName(i) == partitionColumn_) {
+      partition = i;
+      break;
+    }
+  }
+  if (partition == columnSize) {
+    throw std::runtime_error("<Python API Exception> insert: partition "
+      "column " + partitionColumn_ + " is not in the DataFrame");
+  }
+  py::gil_scoped_release release;
+  // the same partition always lands in the same queue
+  size_t queueSize = queues_.size();
+  std::vector<int> buckets(rows);
+  ddb::ConstantSP key = tbl->getColumn(partition);
+  if (!domain_.isNull()) {
+    std::vector<int> keys;
+    try {
+      keys = domain_->getPartitionKeys(key);
+    } catch (std::exception &ex) {
+      throw std::runtime_error(std::string("<Python API Exception> insert: "
+        "column ") + partitionColumn_ + " does not match the partition "
+        "scheme: " + ex.what());
+    }
+    for (size_t i = 0; i < rows; ++i) {
+      // a value outside of the domain is left to the server to reject
+      buckets[i] = keys[i] < 0 ? 0 : static_cast<int>(keys[i] % queueSize);
+    }
+  } else if (!key->getHash(0, static_cast<int>(rows),
+      static_cast<int>(queueSize), buckets.data())) {
+    std::hash<std::string> hasher;
+    for (size_t i = 0; i < rows; ++i) {
+      buckets[i] = static_cast<int>(hasher(key->getString(i)) % queueSize);
+    }
+  }
+  std::vector<std::vector<int>> indices(queueSize);
+  for (size_t i = 0; i < rows; ++i) {
+    indices[buckets[i]].push_back(static_cast<int>(i));
+  }
+  // gather the rows of every queue before taking the lock
+  std::vector<std::vector<ddb::VectorSP>> parts(queueSize);
+  for (size_t q = 0; q < queueSize; ++q) {
+    if (indices[q].empty()) {
+      continue;
+    }
+    ddb::VectorSP index = ddb::Util::createVector(
+      ddb::DT_INT, 0, indices[q].size());
+    index->appendInt(indices[q].data(), indices[q].size());
+    parts[q].reserve(columnSize);
+    for (size_t i = 0; i < columnSize; ++i) {
+      parts[q].emplace_back(tbl->getColumn(i)->get(index));
+    }
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  // close may have stopped the workers while the rows were converted
+  if (stopped_) {
+    throw std::runtime_error("<Python API Exception> insert: "
+      "partitionedTableWriter is closed");
+  }
+  if (columnNames_.empty()) {
+    for (size_t i = 0; i < columnSize; ++i) {
+      columnNames_.push_back(tbl->getColumnName(i));
+      columnTypes_.push_back(tbl->getColumn(i)->getType());
+    }
+  } else if (columnNames_.size() != columnSize) {
+    throw std::runtime_error("<Python API Exception> insert: the DataFrame "
+      "has " + std::to_string(columnSize) + " columns, expected " +
+      std::to_string(columnNames_.size()));
+  } else {
+    // queued rows are appended column by column
+    for (size_t i = 0; i < columnSize; ++i) {
+      if (tbl->getColumnName(i) != columnNames_[i] ||
+          tbl->getColumn(i)->getType() != columnTypes_[i]) {
+        throw std::runtime_error("<Python API Exception> insert: column " +
+          std::to_string(i) + " (" + tbl->getColumnName(i) + ") differs "
+          "from " + columnNames_[i] + " of the first DataFrame in name "
+          "or type");
+      }
+    }
+  }
+  // append to the queues that hold rows first, so a failure leaves every
+  // queue as it was
+  std::vector<size_t> appended;
+  for (size_t q = 0; q < queueSize; ++q) {
+    Queue &queue = *queues_[q];
+    if (parts[q].empty() || queue.rows == 0) {
+      continue;
+    }
+    size_t i = 0;
+    while (i < columnSize && queue.columns[i]->append(parts[q][i])) {
+      ++i;
+    }
+    if (i != columnSize) {
+      for (size_t j = 0; j < i; ++j) {
+        queue.columns[j]->resize(queue.rows);
+      }
+      for (size_t p : appended) {
+        for (auto &column : queues_[p]->columns) {
+          column->resize(queues_[p]->rows);
+        }
+      }
+      throw std::runtime_error("<Python API Exception> insert: failed to "
+        "append column " + columnNames_[i]);
+    }
+    appended.push_back(q);
+  }
+  for (size_t q = 0; q < queueSize; ++q) {
+    if (parts[q].empty()) {
+      continue;
+    }
+    Queue &queue = *queues_[q];
+    if (queue.rows == 0) {
+      queue.columns.swap(parts[q]);
+      queue.since = std::chrono::steady_clock::now();
+    }
+    queue.rows += indices[q].size();
+    queue.cond.notify_one();
+  }
+}
+
+void PartitionedTableWriter::flush()
+{
+  std::string error;
+  {
+    py::gil_scoped_release release;
+    std::unique_lock<std::mutex> lock(mutex_);
+    ++flushing_;
+    for (auto &queue : queues_) {
+      queue->cond.notify_one();
+    }
+    drained_.wait(lock, [this] {
+      for (auto &queue : queues_) {
+        if (queue->rows != 0 || queue->sending != 0) {
+          return false;
+        }
+      }
+      return true;
+    });
+    --flushing_;
+    error.swap(error_);
+  }
+  if (!error.empty()) {
+    throw std::runtime_error("<Server Exception> in flush: " + error);
+  }
+}
+
+size_t PartitionedTableWriter::pending()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t rows = 0;
+  for (auto &queue : queues_) {
+    rows += queue->rows + queue->sending;
+  }
+  return rows;
+}
+
+void PartitionedTableWriter::close()
+{
+  {
+    py::gil_scoped_release release;
+    shutdown();
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  checkError("close");
+}
+
+void PartitionedTableWriter::loadDomain(
+  const std::string &dbPath,
+  const std::string &tableName)
+{
+  py::gil_scoped_release release;
+  ddb::DictionarySP schema = pool_->execute("schema(loadTable(\"" + dbPath +
+    "\", \"" + tableName + "\"))");
+  ddb::ConstantSP names = schema->getMember("partitionColumnName");
+  ddb::ConstantSP type = schema->getMember("partitionType");
+  ddb::ConstantSP colType = schema->getMember("partitionColumnType");
+  ddb::ConstantSP partitionSchema = schema->getMember("partitionSchema");
+  if (names.isNull() || names->getType() == ddb::DT_VOID) {
+    throw std::runtime_error("<Python API Exception> "
+      "partitionedTableWriter: " + tableName + " is not partitioned");
+  }
+  // a COMPO database lists one entry per level, a partition of any level
+  // lies inside one partition of every other level
+  int level = -1;
+  if (names->isScalar()) {
+    if (names->getString() == partitionColumn_) {
+      level = 0;
+    }
+  } else {
+    for (int i = 0; i < names->size(); ++i) {
+      if (names->getString(i) == partitionColumn_) {
+        level = i;
+        break;
+      }
+    }
+    if (level >= 0) {
+      type = type->get(level);
+      colType = colType->get(level);
+      partitionSchema = partitionSchema->get(level);
+    }
+  }
+  if (level < 0) {
+    throw std::runtime_error("<Python API Exception> "
+      "partitionedTableWriter: " + partitionColumn_ + " is not a partition "
+      "column of " + tableName);
+  }
+  domain_ = ddb::Domain::createDomain(
+    static_cast<ddb::PARTITION_TYPE>(type->getInt()),
+    static_cast<ddb::DATA_TYPE>(colType->getInt()), partitionSchema);
+}
+
+void PartitionedTableWriter::shutdown()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+    for (auto &queue : queues_) {
+      queue->cond.notify_one();
+    }
+  }
+  // the workers write what is left before they exit
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  pool_.reset();
+}
+
+void PartitionedTableWriter::checkError(const char *method)
+{
+  if (!error_.empty()) {
+    std::string error;
+    error.swap(error_);
+    throw std::runtime_error(std::string("<Server Exception> in ") + method +
+      ": " + error);
+  }
+}
+
+void PartitionedTableWriter::loop(size_t index)
+{
+  Queue &queue = *queues_[index];
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    if (queue.rows == 0) {
+      if (stopped_) {
+        return;
+      }
+      queue.cond.wait(lock);
+      continue;
+    }
+    if (queue.rows < batchSize_ && flushing_ == 0 && !stopped_ &&
+        queue.cond.wait_until(lock, queue.since + throttle_) ==
+        std::cv_status::no_timeout) {
+      continue;
+    }
+    std::vector<ddb::ConstantSP> columns(
+      queue.columns.begin(), queue.columns.end());
+    queue.columns.clear();
+    queue.sending = queue.rows;
+    queue.rows = 0;
+    lock.unlock();
+    std::string error;
+    try {
+      std::vector<ddb::ConstantSP> args(
+        1, ddb::Util::createTable(columnNames_, columns));
+      pool_->execute(funcName_, args);
+    } catch (std::exception &ex) {
+      error = ex.what();
+    }
+    // drop the sent columns outside the lock
+    columns.clear();
+    lock.lock();
+    queue.sending = 0;
+    if (!error.empty() && error_.empty()) {
+      error_ = error;
+    }
+    drained_.notify_all();
+  }
+}
+
+}  // namespace pydolphindb
@@ -0,0 +1,115 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PYDOLPHINDB_PARTITIONEDTABLEWRITER_H_
+#define PYDOLPHINDB_PARTITIONEDTABLEWRITER_H_
+
+#include <pybind11/pybind11.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <DolphinDB.h>
+
+#include "Utils.h"
+#include "ConnectionPool.h"
+
+namespace pydolphindb
+{
+
+namespace py = pybind11;
+namespace ddb = dolphindb;
+
+// Appends DataFrames to a (DFS) table from several native threads. The
+// partition scheme of the table is fetched once, every row is mapped to its
+// partition (of the level of partitionColumn for a COMPO database) and a
+// partition is always written by the same thread on its own pooled
+// connection, so the threads never contend for a partition. Rows of a
+// shared in-memory table are routed by the hash of partitionColumn.
+// A thread sends its queued rows once there are batchSize of them or
+// throttle milliseconds after the first one.
+// A failed write is reported by the next insert, flush or close.
+class PartitionedTableWriter {
+ public:
+  PartitionedTableWriter(
+    const std::string &host,
+    int port,
+    const std::string &userId,
+    const std::string &password,
+    const std::string &dbPath,
+    const std::string &tableName,
+    const std::string &partitionColumn,
+    int threads,
+    int batchSize,
+    int throttle);
+  ~PartitionedTableWriter();
+  void insert(py::object dataframe);
+  // wait until every queued row is written
+  void flush();
+  // rows queued or being written
+  size_t pending();
+  void close();
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(PartitionedTableWriter);
+  struct Queue {
+    Queue() : cond(), columns(), rows(0), sending(0), since() {}
+    std::condition_variable cond;
+    std::vector<ddb::VectorSP> columns;
+    size_t rows;
+    size_t sending;
+    std::chrono::steady_clock::time_point since;
+  };
+  // the domain of partitionColumn_ from the schema of a DFS table
+  void loadDomain(const std::string &dbPath, const std::string &tableName);
+  void loop(size_t index);
+  void shutdown();
+  // throw and clear the first failed write, requires mutex_
+  void checkError(const char *method);
+  std::mutex mutex_;
+  // signaled whenever a queue finishes a write
+  std::condition_variable drained_;
+  std::string funcName_;
+  std::string partitionColumn_;
+  // null for a shared in-memory table
+  ddb::DomainSP domain_;
+  size_t batchSize_;
+  std::chrono::milliseconds throttle_;
+  bool stopped_;
+  size_t flushing_;
+  std::string error_;
+  // of the first DataFrame, later ones must match
+  std::vector<std::string> columnNames_;
+  std::vector<ddb::DATA_TYPE> columnTypes_;
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::unique_ptr<ConnectionPool> pool_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_PARTITIONEDTABLEWRITER_H_
@@ -20,9 +20,11 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+#include <future>
 #include <vector>
 
 #include "Session.h"
+#include "Arrow.h"
 
 #if defined(__GNUC__) && __GNUC__ >= 4
 #define LIKELY(x) (__builtin_expect((x), 1))
@@ -42,19 +44,38 @@ Session::Session()
   , userId_()
   , password_()
   , encrypted_(true)
+  , reading_(false)
+  , generation_(0)
   , dbConnection_()
-  , nullValuePolicy_([](ddb::VectorSP){})
+  , convertOptions_()
+  , stringAsSymbol_(false)
+  , reuseResultBuffers_(false)
+  , bufferMutex_()
+  , resultBuffers_()
+  , worker_()
 {
 
 }
 
+Session::~Session()
+{
+  if (worker_) {
+    // pending queries complete their futures under the GIL
+    py::gil_scoped_release release;
+    worker_.reset();
+  }
+}
+
 bool Session::connect(
   const std::string &host,
   int port,
   const std::string &userId,
   const std::string &password)
 {
+  checkIdle();
+  py::gil_scoped_release release;
   std::lock_guard<std::mutex> guard(mutex_);
+  ++generation_;
   host_ = host;
   port_ = port;
   userId_ = userId;
@@ -74,6 +95,8 @@ void Session::login(
   const std::string &password,
   bool enableEncryption)
 {
+  checkIdle();
+  py::gil_scoped_release release;
   std::lock_guard<std::mutex> guard(mutex_);
   try {
     dbConnection_.login(userId, password, enableEncryption);
@@ -85,7 +108,11 @@ void Session::login(
 
 void Session::close()
 {
+  // a pending chunked result fails on its next read
+  reading_ = false;
+  py::gil_scoped_release release;
   std::lock_guard<std::mutex> guard(mutex_);
+  ++generation_;
   host_ = "";
   port_ = 0;
   userId_ = "";
@@ -95,6 +122,7 @@ void Session::close()
 
 void Session::upload(py::dict namedObjects)
 {
+  checkIdle();
   vector<std::string> names;
   vector<ddb::ConstantSP> objs;
   for (auto it = namedObjects.begin(); it != namedObjects.end(); ++it) {
@@ -104,10 +132,13 @@ void Session::upload(py::dict namedObjects)
         "in upload dictionary is not allowed");
     }
     names.push_back(it->first.cast<std::string>());
-    objs.push_back(
-      utils::toDolphinDB(py::reinterpret_borrow<py::object>(it->second)));
+    objs.push_back(utils::toDolphinDB(
+      py::reinterpret_borrow<py::object>(it->second), stringAsSymbol_));
   }
   try {
+    // objects are fully converted, no Python state is touched below
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(mutex_);
     dbConnection_.upload(names, objs);
   } catch (std::exception &ex) {
     throw std::runtime_error(std::string("<Server Exception> in upload: ") +
@@ -115,16 +146,81 @@ void Session::upload(py::dict namedObjects)
   }
 }
 
+size_t Session::appendBatched(
+  const std::string &tableName,
+  py::object dataframe,
+  int batchRows)
+{
+  checkIdle();
+  if (batchRows <= 0) {
+    throw std::runtime_error("<Python API Exception> appendBatched: "
+      "batchRows must be positive");
+  }
+  if (!py::isinstance(dataframe, pytype::pddataframe_)) {
+    throw std::runtime_error("<Python API Exception> appendBatched: "
+      "a pandas.DataFrame is required");
+  }
+  if (!worker_) {
+    worker_.reset(new ThreadPool(1));
+  }
+  std::string funcName = "tableInsert{" + tableName + "}";
+  auto wait = [](std::future<void> &inFlight) {
+    try {
+      py::gil_scoped_release release;
+      inFlight.get();
+    } catch (std::exception &ex) {
+      throw std::runtime_error(
+        std::string("<Server Exception> in appendBatched: ") + ex.what());
+    }
+  };
+  // two sets of columns: batch k is converted into one while batch k - 1 is
+  // sent from the other, which is reused once that insert has completed
+  std::vector<ddb::VectorSP> buffers[2];
+  std::future<void> inFlight;
+  size_t rows = py::len(dataframe);
+  size_t step = static_cast<size_t>(batchRows);
+  py::object iloc = dataframe.attr("iloc");
+  for (size_t start = 0, k = 0; start < rows; start += step, ++k) {
+    size_t stop = std::min(rows, start + step);
+    py::object batch = iloc[py::slice(static_cast<py::ssize_t>(start),
+      static_cast<py::ssize_t>(stop), 1)];
+    ddb::TableSP tbl = utils::dataFrameToDolphinDB(
+      batch, buffers[k % 2], stringAsSymbol_);
+    if (inFlight.valid()) {
+      wait(inFlight);
+    }
+    auto done = std::make_shared<std::promise<void>>();
+    inFlight = done->get_future();
+    worker_->submit([this, funcName, tbl, done]() {
+      try {
+        std::vector<ddb::ConstantSP> args(1, tbl);
+        std::lock_guard<std::mutex> guard(mutex_);
+        dbConnection_.run(funcName, args);
+        done->set_value();
+      } catch (...) {
+        done->set_exception(std::current_exception());
+      }
+    });
+  }
+  if (inFlight.valid()) {
+    wait(inFlight);
+  }
+  return rows;
+}
+
 py::object Session::run(const std::string &script)
 {
+  checkIdle();
   ddb::ConstantSP result;
   try {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(mutex_);
     result = dbConnection_.run(script);
   } catch (std::exception &ex) {
     throw std::runtime_error(std::string("<Server Exception> in run: ") +
       ex.what());
   }
-  py::object ret = utils::toPython(result);
+  py::object ret = convert(result);
   return ret;
 }
 
@@ -132,6 +228,7 @@ py::object Session::run(
   const std::string &funcName,
   py::args args)
 {
+  checkIdle();
   vector<ddb::ConstantSP> ddbArgs;
   for (auto it = args.begin(); it != args.end(); ++it) {
     ddbArgs.push_back(
@@ -139,35 +236,284 @@ py::object Session::run(
   }
   ddb::ConstantSP result;
   try {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(mutex_);
     result = dbConnection_.run(funcName, ddbArgs);
   } catch (std::exception &ex) {
     throw std::runtime_error(std::string("<Server Exception> in call: ") +
       ex.what());
   }
-  py::object ret = utils::toPython(result);
+  py::object ret = convert(result);
   return ret;
 }
 
-void Session::nullValueToZero()
+py::object Session::runInto(const std::string &script, py::list buffers)
 {
-  nullValuePolicy_ = [](ddb::VectorSP vec) {
-    if (!vec->hasNull() ||
-      vec->getCategory() == ddb::TEMPORAL ||
-      vec->getType() == ddb::DT_STRING ||
-      vec->getType() == ddb::DT_SYMBOL) {
-      return;
+  checkIdle();
+  ddb::ConstantSP result;
+  try {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(mutex_);
+    result = dbConnection_.run(script);
+  } catch (std::exception &ex) {
+    throw std::runtime_error(std::string("<Server Exception> in run: ") +
+      ex.what());
+  }
+  std::vector<py::object> arrays;
+  for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+    arrays.push_back(py::reinterpret_borrow<py::object>(*it));
+  }
+  py::object ret = utils::toPythonInto(result, arrays, convertOptions_);
+  // hand the grown or replaced arrays back to the caller
+  size_t size = buffers.size();
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    if (i < size) {
+      buffers[i] = arrays[i];
     } else {
-      ddb::ConstantSP val = ddb::Util::createConstant(ddb::DT_LONG);
-      val->setLong(0);
-      vec->nullFill(val);
-      assert(!vec->hasNull());
+      buffers.append(arrays[i]);
     }
-  };
+  }
+  return ret;
+}
+
+py::object Session::convert(const ddb::ConstantSP &result)
+{
+  if (reuseResultBuffers_) {
+    // the pool is filled without the GIL, another thread must neither
+    // resize it nor write into the same arrays meanwhile
+    std::unique_lock<std::mutex> lock(bufferMutex_, std::defer_lock);
+    {
+      py::gil_scoped_release release;
+      lock.lock();
+    }
+    return utils::toPythonInto(result, resultBuffers_, convertOptions_);
+  }
+  return utils::toPython(result, convertOptions_);
+}
+
+py::object Session::runArrow(const std::string &script)
+{
+  checkIdle();
+  ddb::ConstantSP result;
+  try {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(mutex_);
+    result = dbConnection_.run(script);
+  } catch (std::exception &ex) {
+    throw std::runtime_error(std::string("<Server Exception> in run: ") +
+      ex.what());
+  }
+  return arrow::toArrow(result);
+}
+
+std::unique_ptr<ChunkedResult> Session::runChunked(
+  const std::string &script,
+  int chunkRows,
+  bool reuseBuffers)
+{
+  checkIdle();
+  if (chunkRows < 8192) {
+    throw std::runtime_error("<Python API Exception> runChunked: chunkRows "
+      "must be at least 8192");
+  }
+  // a block reader leaves the connection to the iterator, queued queries
+  // must not interleave with its reads
+  drainWorker();
+  ddb::ConstantSP result;
+  uint64_t generation;
+  try {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(mutex_);
+    generation = generation_;
+    // default priority and parallelism, fetchSize makes the server answer
+    // a large table with a block reader
+    result = dbConnection_.run(script, 4, 2, chunkRows);
+  } catch (std::exception &ex) {
+    throw std::runtime_error(std::string("<Server Exception> in run: ") +
+      ex.what());
+  }
+  return std::unique_ptr<ChunkedResult>(new ChunkedResult(
+    mutex_, reading_, generation_, generation, result, convertOptions_,
+    reuseBuffers));
+}
+
+py::object Session::runAsync(const std::string &script)
+{
+  checkIdle();
+  return submit([this, script]() -> ddb::ConstantSP {
+    try {
+      std::lock_guard<std::mutex> guard(mutex_);
+      return dbConnection_.run(script);
+    } catch (std::exception &ex) {
+      throw std::runtime_error(std::string("<Server Exception> in run: ") +
+        ex.what());
+    }
+  }, convertOptions_);
+}
+
+py::object Session::runAsync(
+  const std::string &funcName,
+  py::args args)
+{
+  checkIdle();
+  vector<ddb::ConstantSP> ddbArgs;
+  for (auto it = args.begin(); it != args.end(); ++it) {
+    ddbArgs.push_back(
+      utils::toDolphinDB(py::reinterpret_borrow<py::object>(*it)));
+  }
+  return submit([this, funcName, ddbArgs]() mutable -> ddb::ConstantSP {
+    try {
+      std::lock_guard<std::mutex> guard(mutex_);
+      return dbConnection_.run(funcName, ddbArgs);
+    } catch (std::exception &ex) {
+      throw std::runtime_error(std::string("<Server Exception> in call: ") +
+        ex.what());
+    }
+  }, convertOptions_);
+}
+
+py::object Session::submit(
+  std::function<ddb::ConstantSP()> query,
+  const utils::ConvertOptions &options)
+{
+  // imported lazily, concurrent.futures is not available in Python 2.7
+  py::object future = py::module::import("concurrent.futures")
+    .attr("Future")();
+  if (!worker_) {
+    // one connection serves one query at a time, more threads won't help
+    worker_.reset(new ThreadPool(1));
+  }
+  PyObject *pyFuture = future.ptr();
+  worker_->submit([query, options, pyFuture]() {
+    ddb::ConstantSP result;
+    // an exception may well have an empty message
+    bool failed = false;
+    std::string error;
+    try {
+      result = query();
+    } catch (std::exception &ex) {
+      failed = true;
+      error = ex.what();
+    } catch (...) {
+      failed = true;
+      error = "<Python API Exception> runAsync: unknown error";
+    }
+    py::gil_scoped_acquire acquire;
+    py::object future = py::reinterpret_steal<py::object>(pyFuture);
+    py::object exception;
+    try {
+      if (!future.attr("set_running_or_notify_cancel")().cast<bool>()) {
+        return;
+      }
+      if (!failed) {
+        future.attr("set_result")(utils::toPython(result, options));
+        return;
+      }
+      exception = py::handle(PyExc_RuntimeError)(py::str(error));
+    } catch (py::error_already_set &ex) {
+      // a failed conversion keeps its Python exception type
+      exception = ex.value();
+    } catch (std::exception &ex) {
+      exception = py::handle(PyExc_RuntimeError)(py::str(ex.what()));
+    }
+    try {
+      future.attr("set_exception")(exception);
+    } catch (py::error_already_set &) {
+      // only a future already done refuses an exception, and this one is
+      // running; there is nobody left to raise to
+    }
+  });
+  // the worker owns this reference and drops it with the GIL held; it is
+  // taken only once the task is queued, which the worker cannot reach
+  // before this thread releases the GIL
+  future.inc_ref();
+  return future;
+}
+
+void Session::drainWorker()
+{
+  if (!worker_) {
+    return;
+  }
+  // the worker runs tasks in order, this one completes after all before it
+  auto drained = std::make_shared<std::promise<void>>();
+  std::future<void> done = drained->get_future();
+  worker_->submit([drained]() { drained->set_value(); });
+  // queued queries complete their futures under the GIL
+  py::gil_scoped_release release;
+  done.wait();
+}
+
+void Session::checkIdle() const
+{
+  // the GIL serializes this check with ChunkedResult updating reading_
+  if (reading_) {
+    throw std::runtime_error("<Python API Exception> the session is reading "
+      "a chunked result, exhaust or close it first");
+  }
+}
+
+void Session::nullValueToZero()
+{
+  convertOptions_.nullValuePolicy = utils::NullValuePolicy::ZERO;
 }
 
 void Session::nullValueToNan()
 {
-  nullValuePolicy_ = [](ddb::VectorSP) {};
+  convertOptions_.nullValuePolicy = utils::NullValuePolicy::NAN_VALUE;
+}
+
+void Session::nullValueToSentinel()
+{
+  convertOptions_.nullValuePolicy = utils::NullValuePolicy::SENTINEL;
+}
+
+void Session::nullValueToMasked()
+{
+  convertOptions_.nullValuePolicy = utils::NullValuePolicy::MASKED;
+}
+
+void Session::nullValueToNullable()
+{
+  convertOptions_.nullValuePolicy = utils::NullValuePolicy::NULLABLE;
+}
+
+void Session::setTableFormat(const std::string &format)
+{
+  convertOptions_.tableFormat = utils::TableFormatFromString(format);
+}
+
+void Session::setMatrixFormat(const std::string &format)
+{
+  convertOptions_.matrixFormat = utils::MatrixFormatFromString(format);
+}
+
+void Session::setConvertParallelism(int parallelism)
+{
+  convertOptions_.parallelism = parallelism > 1 ? parallelism : 1;
+}
+
+void Session::setSymbolAsCategorical(bool enable)
+{
+  convertOptions_.symbolAsCategorical = enable;
+}
+
+void Session::setStringAsSymbol(bool enable)
+{
+  stringAsSymbol_ = enable;
+}
+
+void Session::setResultBuffers(bool enable)
+{
+  std::unique_lock<std::mutex> lock(bufferMutex_, std::defer_lock);
+  {
+    py::gil_scoped_release release;
+    lock.lock();
+  }
+  reuseResultBuffers_ = enable;
+  if (!enable) {
+    resultBuffers_.clear();
+  }
 }
 
 }  // namespace pydolphindb
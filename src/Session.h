@@ -26,13 +26,19 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 
+#include <cstdint>
 #include <string>
 #include <mutex>
+#include <memory>
+#include <functional>
+#include <vector>
 
 #include <DolphinDB.h>
 #include <Util.h>
 
 #include "Utils.h"
+#include "ChunkedResult.h"
+#include "ThreadPool.h"
 
 namespace pydolphindb
 {
@@ -43,7 +49,7 @@ namespace ddb = dolphindb;
 class Session {
  public:
   Session();
-  ~Session() = default;
+  ~Session();
   bool connect(
     const std::string &host,
     int port,
@@ -55,20 +61,69 @@ class Session {
     bool enableEncryption);
   void close();
   void upload(py::dict namedObjects);
+  // insert a DataFrame into a table batchRows rows at a time, the next
+  // batch is converted while the previous one is sent
+  size_t appendBatched(
+    const std::string &tableName,
+    py::object dataframe,
+    int batchRows);
   py::object run(const std::string &script);
   py::object run(const std::string &funcName, py::args args);
+  // run, writing fixed width columns into the numpy arrays of buffers,
+  // arrays that are too small or of another dtype are replaced in the list
+  py::object runInto(const std::string &script, py::list buffers);
+  // return a table as pyarrow.Table (a vector as pyarrow.Array)
+  py::object runArrow(const std::string &script);
+  // iterate a large table result in blocks of chunkRows rows
+  std::unique_ptr<ChunkedResult> runChunked(
+    const std::string &script,
+    int chunkRows,
+    bool reuseBuffers);
+  // return a concurrent.futures.Future completed by a native worker thread
+  py::object runAsync(const std::string &script);
+  py::object runAsync(const std::string &funcName, py::args args);
   void nullValueToZero();
   void nullValueToNan();
+  void nullValueToSentinel();
+  void nullValueToMasked();
+  void nullValueToNullable();
+  void setTableFormat(const std::string &format);
+  void setMatrixFormat(const std::string &format);
+  void setConvertParallelism(int parallelism);
+  void setSymbolAsCategorical(bool enable);
+  // upload str columns of DataFrames as SYMBOL instead of STRING
+  void setStringAsSymbol(bool enable);
+  // let run reuse a pool of numpy arrays, a result is overwritten by the next;
+  // conversions into the pool are serialized across threads
+  void setResultBuffers(bool enable);
  private:
   DISALLOW_COPY_MOVE_AND_ASSIGN(Session);
+  void checkIdle() const;
+  py::object convert(const ddb::ConstantSP &result);
+  // wait for the queries queued by runAsync and appendBatched
+  void drainWorker();
+  py::object submit(
+    std::function<ddb::ConstantSP()> query,
+    const utils::ConvertOptions &options);
   std::mutex mutex_;
   std::string host_;
   int port_;
   std::string userId_;
   std::string password_;
   bool encrypted_;
+  // a ChunkedResult still owns the connection
+  bool reading_;
+  // bumped by close and connect, a ChunkedResult of an older generation
+  // must not touch the connection anymore
+  uint64_t generation_;
   ddb::DBConnection dbConnection_;
-  std::function<void(ddb::VectorSP)> nullValuePolicy_;
+  utils::ConvertOptions convertOptions_;
+  bool stringAsSymbol_;
+  bool reuseResultBuffers_;
+  // held for a whole conversion into resultBuffers_, taken without the GIL
+  std::mutex bufferMutex_;
+  std::vector<py::object> resultBuffers_;
+  std::unique_ptr<ThreadPool> worker_;
 };
 
 }  // namespace pydolphindb
@@ -0,0 +1,320 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "StreamAggregator.h"
+
+#include <Util.h>
+
+namespace pydolphindb
+{
+
+AggregateFunction AggregateFunctionFromString(const std::string &function)
+{
+  if (function == "first") {
+    return AggregateFunction::FIRST;
+  } else if (function == "last") {
+    return AggregateFunction::LAST;
+  } else if (function == "max") {
+    return AggregateFunction::MAX;
+  } else if (function == "min") {
+    return AggregateFunction::MIN;
+  } else if (function == "sum") {
+    return AggregateFunction::SUM;
+  } else if (function == "count") {
+    return AggregateFunction::COUNT;
+  } else if (function == "vwap") {
+    return AggregateFunction::VWAP;
+  } else if (function == "rollingMean") {
+    return AggregateFunction::ROLLING_MEAN;
+  } else if (function == "rollingStd") {
+    return AggregateFunction::ROLLING_STD;
+  } else {
+    throw std::runtime_error("<Python API Exception> unknown aggregator: " +
+      function + ", expect first, last, max, min, sum, count, vwap, "
+      "rollingMean or rollingStd");
+  }
+}
+
+StreamAggregator::StreamAggregator(
+  size_t keyColumn,
+  size_t timeColumn,
+  long long window,
+  const std::vector<AggregateSpec> &specs,
+  Deliver deliver)
+  : keyColumn_(keyColumn)
+  , timeColumn_(timeColumn)
+  , width_(std::max(keyColumn, timeColumn) + 1)
+  , window_(window)
+  , specs_(specs)
+  , deliver_(deliver)
+  , mutex_()
+  , timeType_(ddb::DT_VOID)
+  , started_(false)
+  , current_(0)
+  , slots_(64, Slot{0, 0})
+  , states_()
+  , keys_()
+  , times_()
+  , values_(specs.size())
+{
+  for (auto &spec : specs_) {
+    width_ = std::max(width_, spec.column + 1);
+    if (spec.function == AggregateFunction::VWAP) {
+      width_ = std::max(width_, spec.arg + 1);
+    }
+  }
+}
+
+void StreamAggregator::append(const ddb::Message &msg)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (static_cast<size_t>(msg->size()) < width_) {
+    return;
+  }
+  ddb::ConstantSP time = msg->get(timeColumn_);
+  if (time->isNull()) {
+    return;
+  }
+  if (!started_) {
+    timeType_ = time->getType();
+  }
+  long long t = time->getLong();
+  long long start = t / window_;
+  if (t % window_ < 0) {
+    --start;
+  }
+  start *= window_;
+  if (!started_ || start > current_) {
+    if (started_) {
+      closeBefore(start);
+    }
+    started_ = true;
+    current_ = start;
+  } else if (start < current_) {
+    // late, its window was delivered already
+    return;
+  }
+  State &state = lookup(msg->get(keyColumn_)->getString());
+  if (!state.open || state.window != start) {
+    for (auto &cell : state.cells) {
+      cell.a = 0;
+      cell.b = 0;
+      cell.n = 0;
+    }
+    state.window = start;
+    state.open = true;
+  }
+  for (size_t i = 0; i < specs_.size(); ++i) {
+    update(state.cells[i], specs_[i], msg);
+  }
+}
+
+void StreamAggregator::finish()
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  closeBefore(std::numeric_limits<long long>::max());
+}
+
+StreamAggregator::State &StreamAggregator::lookup(const std::string &key)
+{
+  size_t hash = std::hash<std::string>()(key);
+  size_t mask = slots_.size() - 1;
+  for (size_t i = hash & mask; ; i = (i + 1) & mask) {
+    Slot &slot = slots_[i];
+    if (slot.index == 0) {
+      State state;
+      state.key = key;
+      state.window = 0;
+      state.open = false;
+      state.cells.resize(specs_.size());
+      states_.push_back(std::move(state));
+      slot.hash = hash;
+      slot.index = states_.size();
+      // keep the load factor at most one half
+      if (states_.size() * 2 > slots_.size()) {
+        rehash();
+      }
+      return states_.back();
+    }
+    if (slot.hash == hash && states_[slot.index - 1].key == key) {
+      return states_[slot.index - 1];
+    }
+  }
+}
+
+void StreamAggregator::rehash()
+{
+  std::vector<Slot> slots(slots_.size() * 2, Slot{0, 0});
+  size_t mask = slots.size() - 1;
+  for (auto &slot : slots_) {
+    if (slot.index == 0) {
+      continue;
+    }
+    size_t i = slot.hash & mask;
+    while (slots[i].index != 0) {
+      i = (i + 1) & mask;
+    }
+    slots[i] = slot;
+  }
+  slots_.swap(slots);
+}
+
+void StreamAggregator::update(
+  Cell &cell,
+  const AggregateSpec &spec,
+  const ddb::Message &msg)
+{
+  ddb::ConstantSP value = msg->get(spec.column);
+  if (value->isNull()) {
+    return;
+  }
+  double x = value->getDouble();
+  switch (spec.function) {
+    case AggregateFunction::FIRST:
+      if (cell.n == 0) {
+        cell.a = x;
+      }
+      break;
+    case AggregateFunction::LAST:
+      cell.a = x;
+      break;
+    case AggregateFunction::MAX:
+      cell.a = cell.n == 0 ? x : std::max(cell.a, x);
+      break;
+    case AggregateFunction::MIN:
+      cell.a = cell.n == 0 ? x : std::min(cell.a, x);
+      break;
+    case AggregateFunction::SUM:
+      cell.a += x;
+      break;
+    case AggregateFunction::COUNT:
+      break;
+    case AggregateFunction::VWAP:
+    {
+      ddb::ConstantSP volume = msg->get(spec.arg);
+      if (volume->isNull()) {
+        return;
+      }
+      double v = volume->getDouble();
+      cell.a += x * v;
+      cell.b += v;
+      break;
+    }
+    case AggregateFunction::ROLLING_MEAN:
+    case AggregateFunction::ROLLING_STD:
+      if (cell.ring.size() < spec.arg) {
+        cell.ring.push_back(x);
+      } else {
+        cell.ring[cell.pos] = x;
+        cell.pos = (cell.pos + 1) % spec.arg;
+      }
+      break;
+  }
+  ++cell.n;
+}
+
+double StreamAggregator::result(
+  const Cell &cell,
+  const AggregateSpec &spec) const
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  switch (spec.function) {
+    case AggregateFunction::COUNT:
+      return static_cast<double>(cell.n);
+    case AggregateFunction::VWAP:
+      return cell.b != 0 ? cell.a / cell.b : nan;
+    case AggregateFunction::ROLLING_MEAN:
+    case AggregateFunction::ROLLING_STD:
+    {
+      double n = static_cast<double>(cell.ring.size());
+      if (n == 0) {
+        return nan;
+      }
+      double sum = 0;
+      for (double x : cell.ring) {
+        sum += x;
+      }
+      double mean = sum / n;
+      if (spec.function == AggregateFunction::ROLLING_MEAN) {
+        return mean;
+      }
+      if (n < 2) {
+        return nan;
+      }
+      // sample standard deviation in two passes, the deviations from the
+      // mean keep their precision where sumsq - sum^2/n would cancel
+      double squares = 0;
+      for (double x : cell.ring) {
+        squares += (x - mean) * (x - mean);
+      }
+      return std::sqrt(squares / (n - 1));
+    }
+    default:
+      return cell.n != 0 ? cell.a : nan;
+  }
+}
+
+void StreamAggregator::closeBefore(long long start)
+{
+  for (auto &state : states_) {
+    if (!state.open || state.window >= start) {
+      continue;
+    }
+    keys_.push_back(state.key);
+    times_.push_back(state.window);
+    for (size_t i = 0; i < specs_.size(); ++i) {
+      values_[i].push_back(result(state.cells[i], specs_[i]));
+    }
+    state.open = false;
+  }
+  size_t rows = keys_.size();
+  if (rows == 0) {
+    return;
+  }
+  int len = static_cast<int>(rows);
+  std::vector<ddb::VectorSP> columns;
+  columns.push_back(ddb::Util::createVector(ddb::DT_STRING, 0, len));
+  columns.back()->appendString(keys_.data(), len);
+  columns.push_back(ddb::Util::createVector(timeType_, 0, len));
+  columns.back()->appendLong(times_.data(), len);
+  for (size_t i = 0; i < specs_.size(); ++i) {
+    if (specs_[i].function == AggregateFunction::COUNT) {
+      std::vector<long long> counts(values_[i].begin(), values_[i].end());
+      columns.push_back(ddb::Util::createVector(ddb::DT_LONG, 0, len));
+      columns.back()->appendLong(counts.data(), len);
+    } else {
+      columns.push_back(ddb::Util::createVector(ddb::DT_DOUBLE, 0, len));
+      columns.back()->appendDouble(values_[i].data(), len);
+    }
+    values_[i].clear();
+  }
+  keys_.clear();
+  times_.clear();
+  deliver_(columns, rows);
+}
+
+}  // namespace pydolphindb
@@ -0,0 +1,134 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PYDOLPHINDB_STREAMAGGREGATOR_H_
+#define PYDOLPHINDB_STREAMAGGREGATOR_H_
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <DolphinDB.h>
+#include <Streaming.h>
+
+#include "Utils.h"
+
+namespace pydolphindb
+{
+
+namespace ddb = dolphindb;
+
+enum class AggregateFunction {
+  FIRST,
+  LAST,
+  MAX,
+  MIN,
+  SUM,
+  COUNT,
+  VWAP,
+  ROLLING_MEAN,
+  ROLLING_STD
+};
+
+AggregateFunction AggregateFunctionFromString(const std::string &function);
+
+// One output column: function of the values in column. arg is the volume
+// column of VWAP and the number of ticks of the rolling functions, whose
+// window slides across the time windows and is read when a window closes.
+struct AggregateSpec {
+  AggregateFunction function;
+  size_t column;
+  size_t arg;
+  std::string name;
+};
+
+// Per-key tumbling time windows over stream messages, computed without the
+// GIL. A key's state lives in an open addressing hash map. Windows close when
+// the first message of a later window arrives; all closed windows are then
+// handed to deliver at once as columns key, time (window start) and one per
+// spec. Messages older than the current window are dropped.
+class StreamAggregator {
+ public:
+  typedef std::function<void(std::vector<ddb::VectorSP>&, size_t)> Deliver;
+  // window is in the units of the time column (e.g. ms for TIMESTAMP)
+  StreamAggregator(
+    size_t keyColumn,
+    size_t timeColumn,
+    long long window,
+    const std::vector<AggregateSpec> &specs,
+    Deliver deliver);
+  void append(const ddb::Message &msg);
+  // close and deliver the open windows
+  void finish();
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(StreamAggregator);
+  struct Cell {
+    Cell() : a(0), b(0), n(0), ring(), pos(0) {}
+    // per window, reset when the key enters a new window
+    double a;
+    double b;
+    long long n;
+    // the last ticks of a rolling function, summed up only when a window
+    // closes since running sums drift over a long subscription
+    std::vector<double> ring;
+    size_t pos;
+  };
+  struct State {
+    std::string key;
+    long long window;
+    bool open;
+    std::vector<Cell> cells;
+  };
+  struct Slot {
+    size_t hash;
+    // index into states_ plus one, 0 for an empty slot
+    size_t index;
+  };
+  State &lookup(const std::string &key);
+  void rehash();
+  void update(Cell &cell, const AggregateSpec &spec, const ddb::Message &msg);
+  double result(const Cell &cell, const AggregateSpec &spec) const;
+  // close the open windows starting before start, requires mutex_
+  void closeBefore(long long start);
+  size_t keyColumn_;
+  size_t timeColumn_;
+  size_t width_;
+  long long window_;
+  std::vector<AggregateSpec> specs_;
+  Deliver deliver_;
+  std::mutex mutex_;
+  ddb::DATA_TYPE timeType_;
+  bool started_;
+  long long current_;
+  std::vector<Slot> slots_;
+  std::vector<State> states_;
+  // closed windows waiting to be delivered
+  std::vector<std::string> keys_;
+  std::vector<long long> times_;
+  std::vector<std::vector<double>> values_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_STREAMAGGREGATOR_H_
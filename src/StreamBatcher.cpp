@@ -0,0 +1,129 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "StreamBatcher.h"
+
+#include <Util.h>
+
+namespace pydolphindb
+{
+
+StreamBatcher::StreamBatcher(size_t batchSize, int throttle, Deliver deliver)
+  : batchSize_(batchSize)
+  , throttle_(throttle)
+  , deliver_(deliver)
+  , mutex_()
+  , cond_()
+  , columns_()
+  , rows_(0)
+  , since_()
+  , stopped_(false)
+  , thread_()
+{
+  thread_ = std::thread(&StreamBatcher::timer, this);
+}
+
+StreamBatcher::~StreamBatcher()
+{
+  stop();
+}
+
+void StreamBatcher::append(const ddb::Message &msg)
+{
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t width = msg->size();
+  if (columns_.empty()) {
+    for (size_t i = 0; i < width; ++i) {
+      ddb::DATA_TYPE type = msg->get(i)->getType();
+      // symbols arrive as strings, a SYMBOL vector would need a symbol base
+      if (type == ddb::DT_SYMBOL) {
+        type = ddb::DT_STRING;
+      }
+      columns_.push_back(ddb::Util::createVector(
+        type, 0, static_cast<ddb::INDEX>(batchSize_)));
+    }
+  }
+  if (width != columns_.size()) {
+    return;
+  }
+  for (size_t i = 0; i < width; ++i) {
+    columns_[i]->append(msg->get(i));
+  }
+  if (rows_++ == 0) {
+    since_ = std::chrono::steady_clock::now();
+    cond_.notify_one();
+  }
+  if (rows_ >= batchSize_ || stopped_) {
+    flush();
+  }
+}
+
+void StreamBatcher::stop()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_) {
+      return;
+    }
+    stopped_ = true;
+    cond_.notify_one();
+  }
+  // the timer delivers what is left before it exits
+  thread_.join();
+}
+
+void StreamBatcher::flush()
+{
+  std::vector<ddb::VectorSP> columns;
+  columns.reserve(columns_.size());
+  for (auto &column : columns_) {
+    columns.push_back(ddb::Util::createVector(
+      column->getType(), 0, static_cast<ddb::INDEX>(batchSize_)));
+  }
+  columns.swap(columns_);
+  size_t rows = rows_;
+  rows_ = 0;
+  deliver_(columns, rows);
+}
+
+void StreamBatcher::timer()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    if (rows_ == 0) {
+      cond_.wait(lock);
+      continue;
+    }
+    auto deadline = since_ + throttle_;
+    if (std::chrono::steady_clock::now() < deadline) {
+      cond_.wait_until(lock, deadline);
+      continue;
+    }
+    flush();
+  }
+  if (rows_ != 0) {
+    flush();
+  }
+}
+
+}  // namespace pydolphindb
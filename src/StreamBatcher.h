@@ -0,0 +1,79 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PYDOLPHINDB_STREAMBATCHER_H_
+#define PYDOLPHINDB_STREAMBATCHER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <DolphinDB.h>
+#include <Streaming.h>
+
+#include "Utils.h"
+
+namespace pydolphindb
+{
+
+namespace ddb = dolphindb;
+
+// Collects stream messages (one row each) into column vectors and hands the
+// columns to deliver once batchSize rows are collected or throttle
+// milliseconds after the first one. deliver runs on the receiver thread or on
+// the batcher's timer thread, one batch at a time in message order, without
+// the GIL, and must not throw. The columns passed to deliver are not touched
+// by the batcher again.
+class StreamBatcher {
+ public:
+  typedef std::function<void(std::vector<ddb::VectorSP>&, size_t)> Deliver;
+  StreamBatcher(size_t batchSize, int throttle, Deliver deliver);
+  ~StreamBatcher();
+  void append(const ddb::Message &msg);
+  // deliver the remaining rows and stop the timer, the caller must not hold
+  // the GIL if deliver acquires it
+  void stop();
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(StreamBatcher);
+  // requires mutex_
+  void flush();
+  void timer();
+  size_t batchSize_;
+  std::chrono::milliseconds throttle_;
+  Deliver deliver_;
+  // held while a batch is delivered, which keeps the batches in order
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::vector<ddb::VectorSP> columns_;
+  size_t rows_;
+  std::chrono::steady_clock::time_point since_;
+  bool stopped_;
+  std::thread thread_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_STREAMBATCHER_H_
@@ -0,0 +1,259 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "StreamRing.h"
+
+#include <Util.h>
+
+namespace pydolphindb
+{
+
+namespace
+{
+
+// bytes of a value stored in the ring, 0 for types kept as strings
+size_t ringWidth(ddb::DATA_TYPE type)
+{
+  switch (type) {
+    case ddb::DT_BOOL:
+    case ddb::DT_CHAR:
+      return 1;
+    case ddb::DT_SHORT:
+      return 2;
+    case ddb::DT_INT:
+    case ddb::DT_DATE:
+    case ddb::DT_MONTH:
+    case ddb::DT_TIME:
+    case ddb::DT_MINUTE:
+    case ddb::DT_SECOND:
+    case ddb::DT_DATETIME:
+    case ddb::DT_FLOAT:
+      return 4;
+    case ddb::DT_LONG:
+    case ddb::DT_TIMESTAMP:
+    case ddb::DT_NANOTIME:
+    case ddb::DT_NANOTIMESTAMP:
+    case ddb::DT_DOUBLE:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+StreamRing::StreamRing(size_t capacity)
+  : capacity_(capacity)
+  , columns_()
+  , head_(0)
+  , tail_(0)
+  , closed_(false)
+  , pollMutex_()
+{
+
+}
+
+void StreamRing::push(const ddb::Message &msg)
+{
+  if (columns_.empty()) {
+    init(msg);
+  }
+  if (closed_ || msg->size() != columns_.size()) {
+    return;
+  }
+  size_t head = head_.load(std::memory_order_relaxed);
+  while (head - tail_.load(std::memory_order_acquire) >= capacity_) {
+    if (closed_) {
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+  size_t index = head % capacity_;
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    write(columns_[i], index, msg->get(i));
+  }
+  head_.store(head + 1, std::memory_order_release);
+}
+
+py::list StreamRing::poll(int maxRows, int timeout)
+{
+  std::vector<ddb::VectorSP> vectors;
+  {
+    py::gil_scoped_release release;
+    std::lock_guard<std::mutex> guard(pollMutex_);
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    auto deadline = std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(timeout);
+    // spin briefly for a busy feed, then back off
+    for (int spins = 0; head == tail && timeout != 0; ++spins) {
+      if (timeout > 0 && std::chrono::steady_clock::now() >= deadline) {
+        break;
+      }
+      if (closed_) {
+        // nothing arrives anymore, rows pushed before close are still read
+        head = head_.load(std::memory_order_acquire);
+        break;
+      }
+      if (spins < 64) {
+        std::this_thread::yield();
+      } else {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+      head = head_.load(std::memory_order_acquire);
+    }
+    size_t len = head - tail;
+    if (maxRows > 0) {
+      len = std::min(len, static_cast<size_t>(maxRows));
+    }
+    if (len != 0) {
+      for (auto &column : columns_) {
+        vectors.push_back(read(column, tail % capacity_, len));
+      }
+      tail_.store(tail + len, std::memory_order_release);
+    }
+  }
+  py::list pyColumns;
+  for (auto &vec : vectors) {
+    pyColumns.append(utils::toPython(vec));
+  }
+  return pyColumns;
+}
+
+size_t StreamRing::size() const
+{
+  return head_.load(std::memory_order_acquire) -
+    tail_.load(std::memory_order_acquire);
+}
+
+void StreamRing::close()
+{
+  closed_ = true;
+}
+
+void StreamRing::init(const ddb::Message &msg)
+{
+  size_t width = msg->size();
+  std::vector<Column> columns(width);
+  for (size_t i = 0; i < width; ++i) {
+    Column &column = columns[i];
+    column.type = msg->get(i)->getType();
+    column.width = ringWidth(column.type);
+    if (column.width == 0) {
+      // symbols and the other types are kept as strings
+      column.type = ddb::DT_STRING;
+      column.strings.resize(capacity_);
+    } else {
+      column.data.resize(capacity_ * column.width);
+    }
+  }
+  columns_.swap(columns);
+}
+
+void StreamRing::write(
+  Column &column,
+  size_t index,
+  const ddb::ConstantSP &value)
+{
+  char *data = column.data.data();
+  switch (column.type) {
+    case ddb::DT_BOOL:
+    case ddb::DT_CHAR:
+      data[index] = value->getChar();
+      break;
+    case ddb::DT_SHORT:
+      reinterpret_cast<short*>(data)[index] = value->getShort();
+      break;
+    case ddb::DT_FLOAT:
+      reinterpret_cast<float*>(data)[index] = value->getFloat();
+      break;
+    case ddb::DT_DOUBLE:
+      reinterpret_cast<double*>(data)[index] = value->getDouble();
+      break;
+    case ddb::DT_STRING:
+      column.strings[index] = value->getString();
+      break;
+    default:
+      if (column.width == 8) {
+        reinterpret_cast<long long*>(data)[index] = value->getLong();
+      } else {
+        reinterpret_cast<int*>(data)[index] = value->getInt();
+      }
+      break;
+  }
+}
+
+ddb::VectorSP StreamRing::read(Column &column, size_t start, size_t len)
+{
+  ddb::VectorSP vec = ddb::Util::createVector(
+    column.type, 0, static_cast<ddb::INDEX>(len));
+  // at most two runs, the second one from the beginning of the ring
+  size_t first = std::min(len, capacity_ - start);
+  size_t runs[2][2] = {{start, first}, {0, len - first}};
+  for (auto &run : runs) {
+    size_t offset = run[0];
+    int count = static_cast<int>(run[1]);
+    if (count == 0) {
+      continue;
+    }
+    char *data = column.data.data() + offset * column.width;
+    switch (column.type) {
+      case ddb::DT_BOOL:
+        vec->appendBool(data, count);
+        break;
+      case ddb::DT_CHAR:
+        vec->appendChar(data, count);
+        break;
+      case ddb::DT_SHORT:
+        vec->appendShort(reinterpret_cast<short*>(data), count);
+        break;
+      case ddb::DT_FLOAT:
+        vec->appendFloat(reinterpret_cast<float*>(data), count);
+        break;
+      case ddb::DT_DOUBLE:
+        vec->appendDouble(reinterpret_cast<double*>(data), count);
+        break;
+      case ddb::DT_STRING:
+        vec->appendString(column.strings.data() + offset, count);
+        break;
+      default:
+        if (column.width == 8) {
+          vec->appendLong(reinterpret_cast<long long*>(data), count);
+        } else {
+          vec->appendInt(reinterpret_cast<int*>(data), count);
+        }
+        break;
+    }
+  }
+  if (column.width != 0) {
+    // the raw values carry the DolphinDB nulls, flag them for toPython
+    vec->setNullFlag(vec->hasNull(0, static_cast<ddb::INDEX>(len)));
+  }
+  return vec;
+}
+
+}  // namespace pydolphindb
@@ -0,0 +1,90 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PYDOLPHINDB_STREAMRING_H_
+#define PYDOLPHINDB_STREAMRING_H_
+
+#include <pybind11/pybind11.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <DolphinDB.h>
+#include <Streaming.h>
+
+#include "Utils.h"
+
+namespace pydolphindb
+{
+
+namespace py = pybind11;
+namespace ddb = dolphindb;
+
+// Single-producer single-consumer ring of stream rows stored by column.
+// The receiver thread writes every message into preallocated column storage
+// without locks or the GIL; Python drains the rows in bulk with poll. When
+// the ring is full the receiver waits for the consumer (or for close).
+class StreamRing {
+ public:
+  explicit StreamRing(size_t capacity);
+  // producer side, the receiver thread
+  void push(const ddb::Message &msg);
+  // at most maxRows (all if not positive) rows as a list of column arrays,
+  // waiting up to timeout (forever if negative) milliseconds for the first
+  // one; an empty list if none arrived or the ring is closed and empty
+  py::list poll(int maxRows, int timeout);
+  // rows waiting to be polled
+  size_t size() const;
+  // stop waiting for the consumer, later messages are dropped
+  void close();
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(StreamRing);
+  struct Column {
+    Column() : type(ddb::DT_VOID), width(0), data(), strings() {}
+    ddb::DATA_TYPE type;
+    // bytes per value, 0 for strings
+    size_t width;
+    std::vector<char> data;
+    std::vector<std::string> strings;
+  };
+  void init(const ddb::Message &msg);
+  void write(Column &column, size_t index, const ddb::ConstantSP &value);
+  // the rows [start, start + len) of column as a vector, start + len may
+  // wrap around the end of the ring
+  ddb::VectorSP read(Column &column, size_t start, size_t len);
+  size_t capacity_;
+  // written by the producer before the first row is published
+  std::vector<Column> columns_;
+  // rows ever pushed and polled, the difference is the fill level
+  std::atomic<size_t> head_;
+  std::atomic<size_t> tail_;
+  std::atomic<bool> closed_;
+  // poll may be called from several Python threads
+  std::mutex pollMutex_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_STREAMRING_H_
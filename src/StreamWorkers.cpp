@@ -0,0 +1,177 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include <iostream>
+#include <limits>
+#include <string>
+
+#ifdef WINDOWS
+#include <windows.h>
+#elif defined(LINUX)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "StreamWorkers.h"
+
+namespace pydolphindb
+{
+
+namespace
+{
+
+// CPU ids pinThread can set, a larger id does not fit the affinity mask
+int cpuLimit()
+{
+#ifdef WINDOWS
+  return static_cast<int>(sizeof(DWORD_PTR) * 8);
+#elif defined(LINUX)
+  return CPU_SETSIZE;
+#else
+  return std::numeric_limits<int>::max();
+#endif
+}
+
+bool pinThread(std::thread &thread, int cpu)
+{
+#ifdef WINDOWS
+  return SetThreadAffinityMask(
+    thread.native_handle(), static_cast<DWORD_PTR>(1) << cpu) != 0;
+#elif defined(LINUX)
+  cpu_set_t cpus;
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  return pthread_setaffinity_np(
+    thread.native_handle(), sizeof(cpus), &cpus) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+StreamWorkers::StreamWorkers(size_t threads, const std::vector<int> &cpus)
+  : stopped_(false)
+  , workers_()
+{
+  if (threads == 0) {
+    throw std::runtime_error("<Python API Exception> enableStreaming: "
+      "threads must be positive");
+  }
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= cpuLimit()) {
+      throw std::runtime_error("<Python API Exception> enableStreaming: "
+        "cpu " + std::to_string(cpu) + " is out of range [0, " +
+        std::to_string(cpuLimit()) + ")");
+    }
+  }
+  for (size_t i = 0; i < threads; ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (auto &worker : workers_) {
+    worker->thread = std::thread(&StreamWorkers::loop, this,
+      std::ref(*worker));
+  }
+  for (size_t i = 0; i < threads && !cpus.empty(); ++i) {
+    int cpu = cpus[i % cpus.size()];
+    if (!pinThread(workers_[i]->thread, cpu)) {
+      stop();
+      throw std::runtime_error("<Python API Exception> enableStreaming: "
+        "failed to pin a worker to cpu " + std::to_string(cpu));
+    }
+  }
+}
+
+StreamWorkers::~StreamWorkers()
+{
+  stop();
+}
+
+size_t StreamWorkers::size() const
+{
+  return workers_.size();
+}
+
+void StreamWorkers::post(
+  size_t index,
+  const std::shared_ptr<Handler> &handler,
+  const ddb::Message &msg)
+{
+  Worker &worker = *workers_[index];
+  Task task;
+  task.handler = handler;
+  task.msg = msg;
+  worker.queue.push(std::move(task));
+  // pairs with the fence in loop: either the worker's pop sees this push or
+  // this load sees it going to sleep, and the mutex keeps the notification
+  // from arriving before its wait
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (worker.sleeping.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> guard(worker.mutex);
+    worker.cond.notify_one();
+  }
+}
+
+void StreamWorkers::stop()
+{
+  if (stopped_.exchange(true)) {
+    return;
+  }
+  for (auto &worker : workers_) {
+    {
+      std::lock_guard<std::mutex> guard(worker->mutex);
+      worker->cond.notify_one();
+    }
+    worker->thread.join();
+  }
+}
+
+void StreamWorkers::loop(Worker &worker)
+{
+  Task task;
+  while (true) {
+    if (!worker.queue.pop(task)) {
+      std::unique_lock<std::mutex> lock(worker.mutex);
+      worker.sleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      while (!worker.queue.pop(task)) {
+        // stop sets stopped_ before it notifies under the mutex
+        if (stopped_) {
+          worker.sleeping.store(false, std::memory_order_relaxed);
+          return;
+        }
+        worker.cond.wait(lock);
+      }
+      worker.sleeping.store(false, std::memory_order_relaxed);
+    }
+    try {
+      (*task.handler)(task.msg);
+    } catch (std::exception &ex) {
+      std::cout << "<Python API Exception> stream worker: "
+        << ex.what() << std::endl;
+    }
+    task = Task();
+  }
+}
+
+}  // namespace pydolphindb
@@ -0,0 +1,86 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef PYDOLPHINDB_STREAMWORKERS_H_
+#define PYDOLPHINDB_STREAMWORKERS_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <DolphinDB.h>
+#include <Streaming.h>
+
+#include "Utils.h"
+#include "MPSCQueue.h"
+
+namespace pydolphindb
+{
+
+namespace ddb = dolphindb;
+
+// Native threads running stream handlers instead of the receiver threads.
+// Every worker drains its own lock-free queue, so messages posted to one
+// worker are handled in order; a worker is optionally pinned to a CPU.
+// Handlers run without the GIL and must not throw.
+class StreamWorkers {
+ public:
+  typedef std::function<void(const ddb::Message&)> Handler;
+  // worker i is pinned to cpus[i % cpus.size()] unless cpus is empty
+  StreamWorkers(size_t threads, const std::vector<int> &cpus);
+  ~StreamWorkers();
+  size_t size() const;
+  // queue msg for handler on worker index, from any thread
+  void post(
+    size_t index,
+    const std::shared_ptr<Handler> &handler,
+    const ddb::Message &msg);
+  // handle the queued messages and join the workers
+  void stop();
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(StreamWorkers);
+  struct Task {
+    Task() : handler(), msg() {}
+    std::shared_ptr<Handler> handler;
+    ddb::Message msg;
+  };
+  struct Worker {
+    Worker() : queue(), sleeping(false), mutex(), cond(), thread() {}
+    MPSCQueue<Task> queue;
+    std::atomic<bool> sleeping;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread thread;
+  };
+  void loop(Worker &worker);
+  std::atomic<bool> stopped_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_STREAMWORKERS_H_
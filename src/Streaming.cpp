@@ -20,6 +20,10 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 
+
+#include <algorithm>
+#include <functional>
+#include <string>
 #include <vector>
 
 #include "Utils.h"
@@ -30,28 +34,161 @@
 namespace pydolphindb
 {
 
+namespace
+{
+
+// the handler is released by the subscriber threads, which don't hold the GIL
+std::shared_ptr<py::object> sharedHandler(py::object handler)
+{
+  return std::shared_ptr<py::object>(
+    new py::object(handler), [](py::object *obj) {
+      py::gil_scoped_acquire acquire;
+      delete obj;
+    });
+}
+
+// the same key always lands in the same bucket
+size_t keyBucket(const ddb::Message &msg, size_t column, size_t buckets)
+{
+  if (column >= static_cast<size_t>(msg->size())) {
+    return 0;
+  }
+  ddb::ConstantSP key = msg->get(column);
+  int bucket = key->getHash(static_cast<int>(buckets));
+  if (bucket < 0) {
+    bucket = static_cast<int>(
+      std::hash<std::string>()(key->getString()) % buckets);
+  }
+  return static_cast<size_t>(bucket);
+}
+
+// column names of a shared stream table, asked once when subscribing, on a
+// connection of its own without login
+std::vector<std::string> streamColumnNames(
+  const std::string &host,
+  int port,
+  const std::string &tableName)
+{
+  py::gil_scoped_release release;
+  ddb::ConstantSP names;
+  try {
+    ddb::DBConnection conn;
+    conn.connect(host, port);
+    names = conn.run("schema(" + tableName + ").colDefs.name");
+    conn.close();
+  } catch (std::exception &ex) {
+    throw std::runtime_error(std::string("<Server Exception> in subscribe: "
+      "columns of ") + tableName + ": " + ex.what());
+  }
+  std::vector<std::string> columnNames;
+  for (int i = 0; i < names->size(); ++i) {
+    columnNames.push_back(names->getString(i));
+  }
+  return columnNames;
+}
+
+void callHandler(const py::object &handler, py::object arg)
+{
+  try {
+    handler(arg);
+  } catch (std::exception &ex) {
+    std::cout << "<Python API Exception> stream handler: "
+      << ex.what() << std::endl;
+  }
+}
+
+// void(columns, types, ncols, nrows, userData), see subscribeNative
+typedef void (*NativeHandler)(
+  const void* const*, const int*, int, long long, void*);
+
+// the function of a PyCapsule or an address (e.g. numba cfunc.address)
+NativeHandler nativeHandler(py::object callback)
+{
+  void *address = nullptr;
+  if (PyCapsule_CheckExact(callback.ptr())) {
+    address = PyCapsule_GetPointer(
+      callback.ptr(), PyCapsule_GetName(callback.ptr()));
+    if (address == nullptr) {
+      throw py::error_already_set();
+    }
+  } else if (py::isinstance(callback, pytype::pyint_)) {
+    address = reinterpret_cast<void*>(callback.cast<size_t>());
+  }
+  if (address == nullptr) {
+    throw std::runtime_error("<Python API Exception> subscribeNative: "
+      "callback must be a capsule or a nonzero function address");
+  }
+  return reinterpret_cast<NativeHandler>(address);
+}
+
+// hand the raw column buffers to function, strings as arrays of char*
+void callNative(
+  NativeHandler function,
+  void *userData,
+  std::vector<ddb::VectorSP> &columns,
+  size_t rows)
+{
+  size_t columnSize = columns.size();
+  std::vector<const void*> data(columnSize);
+  std::vector<int> types(columnSize);
+  std::vector<std::vector<char*>> strings;
+  for (size_t i = 0; i < columnSize; ++i) {
+    types[i] = columns[i]->getType();
+    if (types[i] == ddb::DT_STRING) {
+      strings.emplace_back(rows);
+      data[i] = columns[i]->getStringConst(
+        0, static_cast<int>(rows), strings.back().data());
+    } else {
+      data[i] = columns[i]->getDataArray();
+    }
+  }
+  function(data.data(), types.data(), static_cast<int>(columnSize),
+    static_cast<long long>(rows), userData);
+}
+
+}  // namespace
+
 Streaming::Streaming()
   : mutex_()
   , subscriber_(nullptr)
   , listeningPort_(-1)
-  , topicThread_()
+  , topics_()
+  , workers_()
+  , nextWorker_(0)
 {
 
 }
 
 Streaming::~Streaming()
 {
-  for (auto &it : topicThread_) {
-    auto args = ddb::Util::split(it.first, '/');
+  // handlers acquire the GIL until their threads are joined
+  py::gil_scoped_release release;
+  std::vector<std::string> topics;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto &it : topics_) {
+      topics.push_back(it.first);
+    }
+  }
+  std::vector<ddb::ThreadSP> threads;
+  for (auto &topic : topics) {
+    auto args = ddb::Util::split(topic, '/');
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      threads.push_back(topics_[topic].thread);
+    }
     try {
-      unsubscribe(args[0], std::stoi(args[1]), args[2], args[3]);
+      unsubscribeTopic(args[0], std::stoi(args[1]), args[2], args[3]);
     } catch (std::exception &ex) {
       std::cout << "<Python API Exception> ~Session: "
         << ex.what() << std::endl;
     }
   }
-  for (auto &it : topicThread_) {
-    it.second->join();
+  for (auto &thread : threads) {
+    thread->join();
+  }
+  if (workers_) {
+    workers_->stop();
   }
 }
 
@@ -59,12 +196,30 @@ void Streaming::listen(int listeningPort)
 {
   std::lock_guard<std::mutex> guard(mutex_);
   if (subscriber_) {
-    listeningPort_ = listeningPort;
-    subscriber_.reset(new ddb::ThreadedClient(listeningPort));
-  } else {
     throw std::runtime_error("<Python API Exception> enableStreaming: "
       "streaming is already enabled on port " + std::to_string(listeningPort_));
   }
+  listeningPort_ = listeningPort;
+  subscriber_.reset(new ddb::ThreadedClient(listeningPort));
+}
+
+void Streaming::setWorkers(int threads, py::list cpus)
+{
+  std::vector<int> cpuIds;
+  for (auto it = cpus.begin(); it != cpus.end(); ++it) {
+    cpuIds.push_back(it->cast<int>());
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (workers_ || !topics_.empty()) {
+    throw std::runtime_error("<Python API Exception> enableStreaming: "
+      "workers must be set once before subscribing");
+  }
+  if (threads <= 0) {
+    throw std::runtime_error("<Python API Exception> enableStreaming: "
+      "threads must be positive");
+  }
+  workers_ = std::make_shared<StreamWorkers>(
+    static_cast<size_t>(threads), cpuIds);
 }
 
 void Streaming::subscribe(
@@ -75,34 +230,275 @@ void Streaming::subscribe(
   const std::string &actionName,
   long long offset,
   bool resub,
-  py::array filter)
+  py::array filter,
+  int batchSize,
+  int throttle,
+  int keyColumn)
 {
-  std::lock_guard<std::mutex> guard(mutex_);
-  if (subscriber_) {
+  if (batchSize > 0 && throttle <= 0) {
     throw std::runtime_error("<Python API Exception> subscribe: "
-      "streaming is not enabled");
+      "throttle must be positive");
   }
-  std::string topic = host + "/" + std::to_string(port) + "/" +
-    tableName + "/" + actionName;
-  if (topicThread_.find(topic) != topicThread_.end()) {
-    throw std::runtime_error("<Python API Exception> subscribe: "
-      "subscription " + topic + " already exists");
-  }
-  ddb::MessageHandler ddbHandler = [handler, this](ddb::Message msg) {
-    // handle GIL
-    py::gil_scoped_acquire acquire;
-    size_t size = msg->size();
-    py::list pyMsg;
-    for (size_t i = 0; i < size; ++i) {
-      pyMsg.append(utils::toPython(msg->get(i)));
+  std::shared_ptr<py::object> pyHandler = sharedHandler(handler);
+  std::vector<std::string> names;
+  if (batchSize > 0) {
+    names = streamColumnNames(host, port, tableName);
+  }
+  Topic topic;
+  ddb::MessageHandler ddbHandler = routeHandler(keyColumn,
+    [&]() -> StreamWorkers::Handler {
+      if (batchSize > 0) {
+        return batchHandler(batchSize, throttle,
+          [pyHandler, names](std::vector<ddb::VectorSP> &columns, size_t) {
+            // one GIL acquisition per batch
+            py::gil_scoped_acquire acquire;
+            py::dict pyColumns;
+            for (size_t i = 0; i < columns.size(); ++i) {
+              // a filtered or altered table may outgrow the names
+              std::string name = i < names.size() ? names[i] :
+                "col" + std::to_string(i);
+              pyColumns[py::str(name)] = utils::toPython(columns[i]);
+            }
+            callHandler(*pyHandler, pyColumns);
+          }, topic);
+      }
+      return [pyHandler](const ddb::Message &msg) {
+        py::gil_scoped_acquire acquire;
+        size_t size = msg->size();
+        py::list pyMsg;
+        for (size_t i = 0; i < size; ++i) {
+          pyMsg.append(utils::toPython(msg->get(i)));
+        }
+        callHandler(*pyHandler, pyMsg);
+      };
+    });
+  subscribeTopic(host, port, tableName, actionName, offset, resub, filter,
+    ddbHandler, topic);
+}
+
+void Streaming::subscribeNative(
+  const std::string &host,
+  int port,
+  py::object callback,
+  const std::string &tableName,
+  const std::string &actionName,
+  long long offset,
+  bool resub,
+  py::array filter,
+  int batchSize,
+  int throttle,
+  int keyColumn,
+  size_t userData)
+{
+  if (batchSize <= 0 || throttle <= 0) {
+    throw std::runtime_error("<Python API Exception> subscribeNative: "
+      "batchSize and throttle must be positive");
+  }
+  NativeHandler function = nativeHandler(callback);
+  // keeps a cfunc or capsule owner alive as long as the subscription
+  std::shared_ptr<py::object> owner = sharedHandler(callback);
+  void *data = reinterpret_cast<void*>(userData);
+  Topic topic;
+  ddb::MessageHandler ddbHandler = routeHandler(keyColumn,
+    [&]() -> StreamWorkers::Handler {
+      return batchHandler(batchSize, throttle,
+        [function, data, owner](std::vector<ddb::VectorSP> &columns,
+          size_t rows) {
+          callNative(function, data, columns, rows);
+        }, topic);
+    });
+  subscribeTopic(host, port, tableName, actionName, offset, resub, filter,
+    ddbHandler, topic);
+}
+
+void Streaming::subscribeAggregated(
+  const std::string &host,
+  int port,
+  py::object handler,
+  const std::string &tableName,
+  const std::string &actionName,
+  long long offset,
+  bool resub,
+  py::array filter,
+  int keyColumn,
+  int timeColumn,
+  long long window,
+  py::list aggregators)
+{
+  if (keyColumn < 0 || timeColumn < 0 || window <= 0) {
+    throw std::runtime_error("<Python API Exception> subscribeAggregated: "
+      "keyColumn and timeColumn must not be negative, window must be "
+      "positive");
+  }
+  std::vector<AggregateSpec> specs;
+  std::vector<std::string> names = {"key", "time"};
+  for (auto it = aggregators.begin(); it != aggregators.end(); ++it) {
+    py::tuple item = py::reinterpret_borrow<py::tuple>(*it);
+    if (item.size() < 2) {
+      throw std::runtime_error("<Python API Exception> subscribeAggregated: "
+        "an aggregator is a tuple (function, column[, arg])");
     }
-    handler(pyMsg);
+    AggregateSpec spec;
+    std::string function = item[0].cast<std::string>();
+    spec.function = AggregateFunctionFromString(function);
+    spec.column = item[1].cast<size_t>();
+    spec.arg = item.size() > 2 ? item[2].cast<size_t>() : 0;
+    bool rolling = spec.function == AggregateFunction::ROLLING_MEAN ||
+      spec.function == AggregateFunction::ROLLING_STD;
+    if (rolling && spec.arg == 0) {
+      throw std::runtime_error("<Python API Exception> subscribeAggregated: "
+        + function + " needs the number of ticks");
+    }
+    if (spec.function == AggregateFunction::VWAP && item.size() < 3) {
+      throw std::runtime_error("<Python API Exception> subscribeAggregated: "
+        "vwap needs the volume column");
+    }
+    spec.name = function + "_" + std::to_string(spec.column);
+    if (rolling || spec.function == AggregateFunction::VWAP) {
+      spec.name += "_" + std::to_string(spec.arg);
+    }
+    // the handler gets a dict, a repeated name would hide a column
+    if (std::find(names.begin(), names.end(), spec.name) != names.end()) {
+      throw std::runtime_error("<Python API Exception> subscribeAggregated: "
+        "aggregator " + spec.name + " is given twice");
+    }
+    names.push_back(spec.name);
+    specs.push_back(spec);
+  }
+  std::shared_ptr<py::object> pyHandler = sharedHandler(handler);
+  Topic topic;
+  // keys are partitioned over the workers, so every key has one state
+  ddb::MessageHandler ddbHandler = routeHandler(keyColumn,
+    [&]() -> StreamWorkers::Handler {
+      std::shared_ptr<StreamAggregator> aggregator =
+        std::make_shared<StreamAggregator>(
+          static_cast<size_t>(keyColumn), static_cast<size_t>(timeColumn),
+          window, specs,
+          [pyHandler, names](std::vector<ddb::VectorSP> &columns, size_t) {
+            py::gil_scoped_acquire acquire;
+            py::dict pyColumns;
+            for (size_t i = 0; i < columns.size(); ++i) {
+              pyColumns[py::str(names[i])] = utils::toPython(columns[i]);
+            }
+            callHandler(*pyHandler, pyColumns);
+          });
+      topic.aggregators.push_back(aggregator);
+      return [aggregator](const ddb::Message &msg) {
+        aggregator->append(msg);
+      };
+    });
+  subscribeTopic(host, port, tableName, actionName, offset, resub, filter,
+    ddbHandler, topic);
+}
+
+std::shared_ptr<StreamRing> Streaming::subscribePolling(
+  const std::string &host,
+  int port,
+  const std::string &tableName,
+  const std::string &actionName,
+  long long offset,
+  bool resub,
+  py::array filter,
+  int capacity)
+{
+  if (capacity <= 0) {
+    throw std::runtime_error("<Python API Exception> subscribePolling: "
+      "capacity must be positive");
+  }
+  Topic topic;
+  topic.ring = std::make_shared<StreamRing>(static_cast<size_t>(capacity));
+  std::shared_ptr<StreamRing> ring = topic.ring;
+  // the receiver thread never touches Python
+  ddb::MessageHandler ddbHandler = [ring](ddb::Message msg) {
+    ring->push(msg);
+  };
+  subscribeTopic(host, port, tableName, actionName, offset, resub, filter,
+    ddbHandler, topic);
+  return ring;
+}
+
+ddb::MessageHandler Streaming::routeHandler(
+  int keyColumn,
+  const std::function<StreamWorkers::Handler()> &makeHandler)
+{
+  std::shared_ptr<StreamWorkers> workers;
+  size_t worker = 0;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    workers = workers_;
+    worker = nextWorker_++;
+  }
+  // a partition per worker when keyed by a column, otherwise one
+  size_t partitions = workers && keyColumn >= 0 ? workers->size() : 1;
+  std::vector<std::shared_ptr<StreamWorkers::Handler>> handlers;
+  for (size_t i = 0; i < partitions; ++i) {
+    handlers.push_back(
+      std::make_shared<StreamWorkers::Handler>(makeHandler()));
+  }
+  if (!workers) {
+    std::shared_ptr<StreamWorkers::Handler> handle = handlers[0];
+    return [handle](ddb::Message msg) {
+      (*handle)(msg);
+    };
+  }
+  if (keyColumn < 0) {
+    // the whole topic on one worker, assigned round robin
+    std::shared_ptr<StreamWorkers::Handler> handle = handlers[0];
+    size_t index = worker % workers->size();
+    return [workers, handle, index](ddb::Message msg) {
+      workers->post(index, handle, msg);
+    };
+  }
+  size_t column = static_cast<size_t>(keyColumn);
+  return [workers, handlers, column](ddb::Message msg) {
+    size_t index = keyBucket(msg, column, workers->size());
+    workers->post(index, handlers[index], msg);
+  };
+}
+
+StreamWorkers::Handler Streaming::batchHandler(
+  int batchSize,
+  int throttle,
+  StreamBatcher::Deliver deliver,
+  Topic &topic)
+{
+  std::shared_ptr<StreamBatcher> batcher = std::make_shared<StreamBatcher>(
+    static_cast<size_t>(batchSize), throttle, deliver);
+  topic.batchers.push_back(batcher);
+  return [batcher](const ddb::Message &msg) {
+    batcher->append(msg);
   };
+}
+
+void Streaming::subscribeTopic(
+  const std::string &host,
+  int port,
+  const std::string &tableName,
+  const std::string &actionName,
+  long long offset,
+  bool resub,
+  py::array filter,
+  ddb::MessageHandler handler,
+  Topic &topic)
+{
   ddb::VectorSP
     ddbFilter = filter.size() ? utils::toDolphinDB(filter) : nullptr;
-  ddb::ThreadSP thread = subscriber_->subscribe(
-    host, port, ddbHandler,tableName, actionName, offset, resub, ddbFilter);
-  topicThread_[topic] = thread;
+  std::string key = host + "/" + std::to_string(port) + "/" +
+    tableName + "/" + actionName;
+  // subscribing connects to the publisher
+  py::gil_scoped_release release;
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!subscriber_) {
+    throw std::runtime_error("<Python API Exception> subscribe: "
+      "streaming is not enabled");
+  }
+  if (topics_.find(key) != topics_.end()) {
+    throw std::runtime_error("<Python API Exception> subscribe: "
+      "subscription " + key + " already exists");
+  }
+  topic.thread = subscriber_->subscribe(
+    host, port, handler, tableName, actionName, offset, resub, ddbFilter);
+  topics_[key] = topic;
 }
 
 void Streaming::unsubscribe(
@@ -111,26 +507,52 @@ void Streaming::unsubscribe(
   std::string tableName,
   std::string actionName)
 {
-  std::lock_guard<std::mutex> guard(mutex_);
-  if (subscriber_) {
-    throw std::runtime_error("<Python API Exception> unsubscribe: "
-      "streaming is not enabled");
+  py::gil_scoped_release release;
+  unsubscribeTopic(host, port, tableName, actionName);
+}
+
+void Streaming::unsubscribeTopic(
+  const std::string &host,
+  int port,
+  const std::string &tableName,
+  const std::string &actionName)
+{
+  Topic topic;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!subscriber_) {
+      throw std::runtime_error("<Python API Exception> unsubscribe: "
+        "streaming is not enabled");
+    }
+    std::string key = host + "/" + std::to_string(port) + "/" +
+      tableName + "/" + actionName;
+    auto it = topics_.find(key);
+    if (it == topics_.end()) {
+      throw std::runtime_error("<Python API Exception> unsubscribe: "
+        "subscription " + key + " not exists");
+    }
+    topic = it->second;
+    topics_.erase(it);
+    if (topic.ring) {
+      // a receiver waiting for room gives up, poll still drains the ring
+      topic.ring->close();
+    }
+    subscriber_->unsubscribe(host, port, tableName, actionName);
   }
-  std::string topic = host + "/" + std::to_string(port) + "/" + 
-    tableName + "/" + actionName;
-  if (topicThread_.find(topic) == topicThread_.end()) {
-    throw std::runtime_error("<Python API Exception> unsubscribe: "
-      "subscription " + topic + " not exists");
+  for (auto &batcher : topic.batchers) {
+    // hand the last rows to the handler
+    batcher->stop();
+  }
+  for (auto &aggregator : topic.aggregators) {
+    aggregator->finish();
   }
-  subscriber_->unsubscribe(host, port, tableName, actionName);
-  topicThread_.erase(topic);
 }
 
 py::list Streaming::getSubscriptionTopics()
 {
   std::lock_guard<std::mutex> guard(mutex_);
   py::list topics;
-  for (auto &it : topicThread_) {
+  for (auto &it : topics_) {
     topics.append(it.first);
   }
   return topics;
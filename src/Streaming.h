@@ -29,11 +29,18 @@
 #include <string>
 #include <unordered_map>
 #include <mutex>
+#include <functional>
 #include <memory>
+#include <vector>
 
 #include <DolphinDB.h>
 #include <Streaming.h>
 
+#include "StreamBatcher.h"
+#include "StreamRing.h"
+#include "StreamWorkers.h"
+#include "StreamAggregator.h"
+
 namespace pydolphindb
 {
 
@@ -45,6 +52,15 @@ class Streaming {
   Streaming();
   ~Streaming();
   void listen(int listeningPort);
+  // handle the messages on threads native workers (pinned to cpus if not
+  // empty) instead of the receiver threads, before the first subscribe
+  void setWorkers(int threads, py::list cpus);
+  // with batchSize > 0 handler receives a dict of column arrays, keyed by
+  // the column names of the stream table (read once here), per batch of up
+  // to batchSize messages (throttle milliseconds at most), otherwise a list
+  // of values per message. With workers a topic is handled by one of
+  // them, or, with keyColumn >= 0, partitioned over all of them by the hash
+  // of that column.
   void subscribe(
     const std::string &host,
     int port,
@@ -53,7 +69,61 @@ class Streaming {
     const std::string &actionName,
     long long offset,
     bool resub,
-    py::array filter);
+    py::array filter,
+    int batchSize,
+    int throttle,
+    int keyColumn);
+  // callback is a PyCapsule or the address of a C function
+  //   void(const void* const* columns, const int* types, int ncols,
+  //        long long nrows, void* userData)
+  // called for every batch without the GIL, on the receiver (or worker)
+  // thread for a full batch and on the batcher's timer thread for one
+  // flushed after throttle; the batches of a topic (or of a key partition)
+  // are delivered one at a time and in order. columns[i] points to nrows
+  // raw values of DolphinDB type types[i] (nulls are the DolphinDB null
+  // values) or, for strings, to nrows char*. The buffers are only valid
+  // during the call.
+  void subscribeNative(
+    const std::string &host,
+    int port,
+    py::object callback,
+    const std::string &tableName,
+    const std::string &actionName,
+    long long offset,
+    bool resub,
+    py::array filter,
+    int batchSize,
+    int throttle,
+    int keyColumn,
+    size_t userData);
+  // aggregate the messages natively per key (keyColumn) over tumbling
+  // windows of the time column, handler receives a dict of column arrays
+  // (key, time, then one per aggregator) for the windows closed at once.
+  // aggregators are tuples (function, column[, arg]) named function_column,
+  // arg is the volume column of vwap and the tick count of rollingMean/Std.
+  void subscribeAggregated(
+    const std::string &host,
+    int port,
+    py::object handler,
+    const std::string &tableName,
+    const std::string &actionName,
+    long long offset,
+    bool resub,
+    py::array filter,
+    int keyColumn,
+    int timeColumn,
+    long long window,
+    py::list aggregators);
+  // messages are buffered in a ring of capacity rows and drained with poll
+  std::shared_ptr<StreamRing> subscribePolling(
+    const std::string &host,
+    int port,
+    const std::string &tableName,
+    const std::string &actionName,
+    long long offset,
+    bool resub,
+    py::array filter,
+    int capacity);
   void unsubscribe(
     std::string host,
     int port,
@@ -62,10 +132,48 @@ class Streaming {
   py::list getSubscriptionTopics();
  private:
   DISALLOW_COPY_MOVE_AND_ASSIGN(Streaming);
+  struct Topic {
+    ddb::ThreadSP thread;
+    // empty when messages are handled one by one, one per partition
+    std::vector<std::shared_ptr<StreamBatcher>> batchers;
+    // null unless subscribed for polling
+    std::shared_ptr<StreamRing> ring;
+    // one per partition when aggregated
+    std::vector<std::shared_ptr<StreamAggregator>> aggregators;
+  };
+  // one handler per partition from makeHandler, posted to the workers if any
+  ddb::MessageHandler routeHandler(
+    int keyColumn,
+    const std::function<StreamWorkers::Handler()> &makeHandler);
+  // a handler appending to a new batcher of topic
+  StreamWorkers::Handler batchHandler(
+    int batchSize,
+    int throttle,
+    StreamBatcher::Deliver deliver,
+    Topic &topic);
+  // register topic with handler, requires the GIL
+  void subscribeTopic(
+    const std::string &host,
+    int port,
+    const std::string &tableName,
+    const std::string &actionName,
+    long long offset,
+    bool resub,
+    py::array filter,
+    ddb::MessageHandler handler,
+    Topic &topic);
+  // the caller must not hold the GIL
+  void unsubscribeTopic(
+    const std::string &host,
+    int port,
+    const std::string &tableName,
+    const std::string &actionName);
   std::mutex mutex_;
   std::unique_ptr<ddb::ThreadedClient> subscriber_;
   int listeningPort_;
-  std::unordered_map<std::string, ddb::ThreadSP> topicThread_;
+  std::unordered_map<std::string, Topic> topics_;
+  std::shared_ptr<StreamWorkers> workers_;
+  size_t nextWorker_;
 };
 
 }  // namespace pydolphindb
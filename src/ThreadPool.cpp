@@ -0,0 +1,140 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+namespace pydolphindb
+{
+
+ThreadPool::ThreadPool(size_t threads)
+  : mutex_()
+  , cond_()
+  , tasks_()
+  , stopped_(false)
+  , workers_()
+{
+  if (threads == 0) {
+    threads = 1;
+  }
+  workers_.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    workers_.emplace_back(&ThreadPool::loop, this);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    stopped_ = true;
+  }
+  cond_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stopped_) {
+      throw std::runtime_error("<Python API Exception> thread pool: "
+        "submit after shutdown");
+    }
+    tasks_.push_back(std::move(task));
+  }
+  cond_.notify_one();
+}
+
+void ThreadPool::parallelFor(
+  size_t n,
+  size_t parallelism,
+  const std::function<void(size_t)> &fn)
+{
+  struct State {
+    std::atomic<size_t> next;
+    std::mutex mutex;
+    std::condition_variable cond;
+    size_t running;
+    std::exception_ptr error;
+  };
+  std::shared_ptr<State> state = std::make_shared<State>();
+  state->next = 0;
+  state->running = 0;
+  auto body = [state, n, &fn]() {
+    for (size_t i = state->next++; i < n; i = state->next++) {
+      try {
+        fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> guard(state->mutex);
+        if (!state->error) {
+          state->error = std::current_exception();
+        }
+      }
+    }
+  };
+  size_t helpers = std::min(std::min(parallelism, n), workers_.size() + 1);
+  helpers = helpers > 0 ? helpers - 1 : 0;
+  state->running = helpers;
+  for (size_t i = 0; i < helpers; ++i) {
+    submit([state, body]() {
+      body();
+      std::lock_guard<std::mutex> guard(state->mutex);
+      if (--state->running == 0) {
+        state->cond.notify_all();
+      }
+    });
+  }
+  body();
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cond.wait(lock, [&state] { return state->running == 0; });
+  if (state->error) {
+    std::rethrow_exception(state->error);
+  }
+}
+
+size_t ThreadPool::size() const
+{
+  return workers_.size();
+}
+
+void ThreadPool::loop()
+{
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] { return stopped_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+}  // namespace pydolphindb
@@ -0,0 +1,70 @@
+// MIT License
+
+// Copyright (c) 2019 jasonyuchen
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PYDOLPHINDB_THREADPOOL_H_
+#define PYDOLPHINDB_THREADPOOL_H_
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+#include "Utils.h"
+
+namespace pydolphindb
+{
+
+// Fixed size pool of native worker threads. Tasks never run with the GIL
+// held, they must acquire it themselves before touching Python objects,
+// and they must not throw.
+// The destructor runs all queued tasks before joining, so the owner must
+// release the GIL while destroying a pool whose tasks acquire it.
+class ThreadPool {
+ public:
+  explicit ThreadPool(size_t threads);
+  ~ThreadPool();
+  void submit(std::function<void()> task);
+  // run fn(0)..fn(n-1) on at most parallelism threads including the caller
+  // and wait for all of them, the first exception thrown is rethrown here
+  void parallelFor(
+    size_t n,
+    size_t parallelism,
+    const std::function<void(size_t)> &fn);
+  size_t size() const;
+ private:
+  DISALLOW_COPY_MOVE_AND_ASSIGN(ThreadPool);
+  void loop();
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::function<void()>> tasks_;
+  bool stopped_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace pydolphindb
+
+#endif  // PYDOLPHINDB_THREADPOOL_H_
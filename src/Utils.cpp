@@ -22,10 +22,19 @@
 
 #include <pybind11/numpy.h>
 
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
 #include <DolphinDB.h>
 #include <Util.h>
 
 #include "Utils.h"
+#include "Arrow.h"
+#include "Kernels.h"
+#include "ThreadPool.h"
 
 #if defined(__GNUC__) && __GNUC__ >= 4
 #define LIKELY(x) (__builtin_expect((x), 1))
@@ -51,6 +60,8 @@ namespace pyfunction
 
 const handle isnan_ = pymodule::numpy_.attr("isnan");
 const handle sum_ = pymodule::numpy_.attr("sum");
+const handle ascontiguousarray_ = pymodule::numpy_.attr("ascontiguousarray");
+const handle asfortranarray_ = pymodule::numpy_.attr("asfortranarray");
 
 }  // namespace pyfunction
 
@@ -59,6 +70,10 @@ namespace pytype
 
 const handle datetime64_ = pymodule::numpy_.attr("datetime64");
 const handle pddataframe_ = pymodule::pandas_.attr("DataFrame")().get_type().inc_ref();
+const handle pdcategorical_ =
+  py::object(pymodule::pandas_.attr("Categorical")).inc_ref();
+const handle pdcategoricaldtype_ = py::object(pymodule::pandas_.attr("api")
+  .attr("types").attr("CategoricalDtype")).inc_ref();
 const handle nparray_ = py::array().get_type().inc_ref();
 const handle npbool_ = py::dtype("bool").inc_ref();
 const handle npint8_ = py::dtype("int8").inc_ref();
@@ -91,6 +106,32 @@ const handle pydict_ = py::dict().get_type().inc_ref();
 namespace utils
 {
 
+TableFormat TableFormatFromString(const std::string &format)
+{
+  if (format == "dataframe") {
+    return TableFormat::DATAFRAME;
+  } else if (format == "dict") {
+    return TableFormat::DICT;
+  } else if (format == "recarray") {
+    return TableFormat::RECARRAY;
+  } else {
+    throw std::runtime_error("<Python API Exception> unknown table format: " +
+      format + ", expect dataframe, dict or recarray");
+  }
+}
+
+MatrixFormat MatrixFormatFromString(const std::string &format)
+{
+  if (format == "list") {
+    return MatrixFormat::LIST;
+  } else if (format == "dataframe") {
+    return MatrixFormat::DATAFRAME;
+  } else {
+    throw std::runtime_error("<Python API Exception> unknown matrix format: " +
+      format + ", expect list or dataframe");
+  }
+}
+
 std::string DataCategoryToString(ddb::DATA_CATEGORY cate) noexcept
 {
   switch (cate) {
@@ -220,10 +261,984 @@ ddb::DATA_TYPE DataTypeFromNumpyArray(py::array array)
     return ddb::DT_ANY;
 }
 
+namespace
+{
+
+// shared by all sessions, never destroyed so no worker is joined while the
+// interpreter is finalizing
+ThreadPool &conversionPool()
+{
+  static ThreadPool *pool = new ThreadPool(
+    std::max(1u, std::thread::hardware_concurrency()));
+  return *pool;
+}
+
+template <typename T>
+void copyValues(const T *src, T *dst, size_t len)
+{
+  std::memcpy(dst, src, len * sizeof(T));
+}
+
+// how a numeric vector with nulls is laid out for numpy, selected at compile
+// time so the policy is applied inside the copy
+template <NullValuePolicy P>
+struct NullFill;
+
+// NaN, integer and FLOAT vectors widen to float64
+template <>
+struct NullFill<NullValuePolicy::NAN_VALUE>
+{
+  static const bool keepsDtype = false;
+  template <typename T>
+  static void fill(const ddb::VectorSP &vec, void *dst, size_t size)
+  {
+    convertByBlock<T, double>(
+      vec, reinterpret_cast<double*>(dst), size, kernels::nullToNan);
+  }
+};
+
+// 0 in the vector's own dtype
+template <>
+struct NullFill<NullValuePolicy::ZERO>
+{
+  static const bool keepsDtype = true;
+  template <typename T>
+  static void fill(const ddb::VectorSP &vec, void *dst, size_t size)
+  {
+    convertByBlock<T, T>(
+      vec, reinterpret_cast<T*>(dst), size, kernels::nullToZero);
+  }
+};
+
+// the DolphinDB null values as they are
+template <>
+struct NullFill<NullValuePolicy::SENTINEL>
+{
+  static const bool keepsDtype = true;
+  template <typename T>
+  static void fill(const ddb::VectorSP &vec, void *dst, size_t size)
+  {
+    convertByBlock<T, T>(vec, reinterpret_cast<T*>(dst), size, copyValues);
+  }
+};
+
+// hand the vector's own contiguous buffer to numpy without copying, the
+// capsule set as the array base keeps the vector alive
+bool wrapVectorBuffer(
+  const ddb::VectorSP &vec,
+  const char *dtype,
+  size_t size,
+  py::object &pyVec)
+{
+  if (!vec->isFastMode() || vec->getDataArray() == nullptr) {
+    return false;
+  }
+  auto *owner = new ddb::VectorSP(vec);
+  py::capsule base(owner, [](void *p) {
+    delete reinterpret_cast<ddb::VectorSP*>(p);
+  });
+  pyVec = py::array(py::dtype(dtype), {size}, {}, vec->getDataArray(), base);
+  return true;
+}
+
+// a SYMBOL vector stores int indices into its symbol base, getIntConst
+// hands them out without building a string per element and the string of
+// an index is only asked for at its first occurrence, fn(i, code)
+template <typename F>
+void forEachSymbolCode(const ddb::VectorSP &vec, size_t size, F fn)
+{
+  const size_t blockSize = 4096;
+  int buf[blockSize];
+  for (size_t start = 0; start < size; start += blockSize) {
+    int len = static_cast<int>(std::min(blockSize, size - start));
+    const int *codes = vec->getIntConst(
+      static_cast<ddb::INDEX>(start), len, buf);
+    for (int i = 0; i < len; ++i) {
+      fn(start + i, static_cast<size_t>(codes[i]));
+    }
+  }
+}
+
+// object array of str, equal strings share one Python object. SYMBOL
+// vectors always repeat and are cached by index, for STRING vectors the
+// cache is dropped once it is clear that most values are distinct
+py::array stringArray(const ddb::VectorSP &vec, size_t size, bool isSymbol)
+{
+  const size_t probeSize = 1024;
+  py::array pyVec(py::dtype("object"), {size}, {});
+  // the array owns one reference per element, the caches borrow them
+  PyObject **p = reinterpret_cast<PyObject**>(pyVec.mutable_data());
+  if (isSymbol) {
+    std::vector<PyObject*> byCode;
+    forEachSymbolCode(vec, size, [&](size_t i, size_t code) {
+      if (code >= byCode.size()) {
+        byCode.resize(code + 1, nullptr);
+      }
+      if (byCode[code] == nullptr) {
+        p[i] = py::str(vec->getString(static_cast<ddb::INDEX>(i)))
+          .release().ptr();
+        byCode[code] = p[i];
+        return;
+      }
+      Py_INCREF(byCode[code]);
+      p[i] = byCode[code];
+    });
+    return pyVec;
+  }
+  std::unordered_map<std::string, PyObject*> cache;
+  bool interning = true;
+  for (size_t i = 0; i < size; ++i) {
+    std::string str = vec->getString(i);
+    if (LIKELY(interning)) {
+      auto it = cache.find(str);
+      if (it != cache.end()) {
+        Py_INCREF(it->second);
+        p[i] = it->second;
+        continue;
+      }
+      p[i] = py::str(str).release().ptr();
+      cache.emplace(std::move(str), p[i]);
+      if (i + 1 == probeSize && cache.size() * 2 > probeSize) {
+        interning = false;
+        cache.clear();
+      }
+    } else {
+      p[i] = py::str(str).release().ptr();
+    }
+  }
+  return pyVec;
+}
+
+// pandas.Categorical built from int32 codes and one str per distinct symbol,
+// the empty (null) symbol becomes a missing value
+py::object symbolCategorical(const ddb::VectorSP &vec, size_t size)
+{
+  const int unseen = -2;
+  py::array codes(py::dtype("int32"), {size}, {});
+  int *c = reinterpret_cast<int*>(codes.mutable_data());
+  // symbol base index to category code, the categories keep the order of
+  // first occurrence
+  std::vector<int> codeOf;
+  py::list categories;
+  forEachSymbolCode(vec, size, [&](size_t i, size_t code) {
+    if (code >= codeOf.size()) {
+      codeOf.resize(code + 1, unseen);
+    }
+    if (codeOf[code] == unseen) {
+      std::string str = vec->getString(static_cast<ddb::INDEX>(i));
+      if (str.empty()) {
+        codeOf[code] = -1;
+      } else {
+        codeOf[code] = static_cast<int>(py::len(categories));
+        categories.append(py::str(str));
+      }
+    }
+    c[i] = codeOf[code];
+  });
+  return pymodule::pandas_.attr("Categorical").attr("from_codes")(
+    codes, categories);
+}
+
+// numpy dtype of a fixed width vector, nullptr when the vector needs
+// Python objects (strings, ANY, BOOL with nulls converted to NaN)
+template <NullValuePolicy P>
+const char *fixedWidthDtype(ddb::DATA_TYPE type, bool hasNull)
+{
+  bool widen = hasNull && !NullFill<P>::keepsDtype;
+  switch (type) {
+    case ddb::DT_BOOL:
+      if (!hasNull || P == NullValuePolicy::ZERO) {
+        return "bool";
+      }
+      // the BOOL null is -128
+      return P == NullValuePolicy::SENTINEL ? "int8" : nullptr;
+    case ddb::DT_CHAR: return widen ? "float64" : "int8";
+    case ddb::DT_SHORT: return widen ? "float64" : "int16";
+    case ddb::DT_INT: return widen ? "float64" : "int32";
+    case ddb::DT_LONG: return widen ? "float64" : "int64";
+    case ddb::DT_DATE: return "datetime64[D]";
+    case ddb::DT_MONTH: return "datetime64[M]";
+    case ddb::DT_TIME: return "datetime64[ms]";
+    case ddb::DT_MINUTE: return "datetime64[m]";
+    case ddb::DT_SECOND: return "datetime64[s]";
+    case ddb::DT_DATETIME: return "datetime64[s]";
+    case ddb::DT_TIMESTAMP: return "datetime64[ms]";
+    case ddb::DT_NANOTIME: return "datetime64[ns]";
+    case ddb::DT_NANOTIMESTAMP: return "datetime64[ns]";
+    case ddb::DT_FLOAT: return widen ? "float64" : "float32";
+    case ddb::DT_DOUBLE: return "float64";
+    default: return nullptr;
+  }
+}
+
+// whether the vector's own buffer already is the numpy representation,
+// LONG null is NaT so the 64-bit temporal types qualify even with nulls
+template <NullValuePolicy P>
+bool isSharable(ddb::DATA_TYPE type, bool hasNull)
+{
+  switch (type) {
+    case ddb::DT_CHAR:
+    case ddb::DT_SHORT:
+    case ddb::DT_INT:
+    case ddb::DT_LONG:
+    case ddb::DT_FLOAT:
+    case ddb::DT_DOUBLE:
+      return !hasNull || P == NullValuePolicy::SENTINEL;
+    case ddb::DT_TIMESTAMP:
+    case ddb::DT_NANOTIME:
+    case ddb::DT_NANOTIMESTAMP:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// fill a buffer laid out as fixedWidthDtype<P>(type, hasNull), never touches
+// Python so it may run without the GIL
+template <NullValuePolicy P>
+void fillFixedWidth(
+  const ddb::VectorSP &vec,
+  ddb::DATA_TYPE type,
+  bool hasNull,
+  void *dst,
+  size_t size)
+{
+  switch (type) {
+    case ddb::DT_BOOL:
+      if (UNLIKELY(hasNull && P == NullValuePolicy::ZERO)) {
+        NullFill<P>::template fill<char>(vec, dst, size);
+      } else {
+        vec->getBool(0, size, reinterpret_cast<char*>(dst));
+      }
+      break;
+    case ddb::DT_CHAR:
+      if (UNLIKELY(hasNull)) {
+        NullFill<P>::template fill<char>(vec, dst, size);
+      } else {
+        vec->getChar(0, size, reinterpret_cast<char*>(dst));
+      }
+      break;
+    case ddb::DT_SHORT:
+      if (UNLIKELY(hasNull)) {
+        NullFill<P>::template fill<short>(vec, dst, size);
+      } else {
+        vec->getShort(0, size, reinterpret_cast<short*>(dst));
+      }
+      break;
+    case ddb::DT_INT:
+      if (UNLIKELY(hasNull)) {
+        NullFill<P>::template fill<int>(vec, dst, size);
+      } else {
+        vec->getInt(0, size, reinterpret_cast<int*>(dst));
+      }
+      break;
+    case ddb::DT_LONG:
+      if (UNLIKELY(hasNull)) {
+        NullFill<P>::template fill<long long>(vec, dst, size);
+      } else {
+        vec->getLong(0, size, reinterpret_cast<long long*>(dst));
+      }
+      break;
+    case ddb::DT_MONTH:
+    {
+      long long *p = reinterpret_cast<long long*>(dst);
+      vec->getLong(0, size, p);
+      for (size_t i = 0; i < size; ++i) {
+        if (UNLIKELY(p[i] == INT64_MIN)) {
+          continue;
+        }
+        p[i] -= 1970*12;
+      }
+      break;
+    }
+    case ddb::DT_DATE:
+    case ddb::DT_TIME:
+    case ddb::DT_MINUTE:
+    case ddb::DT_SECOND:
+    case ddb::DT_DATETIME:
+    case ddb::DT_TIMESTAMP:
+    case ddb::DT_NANOTIME:
+    case ddb::DT_NANOTIMESTAMP:
+      vec->getLong(0, size, reinterpret_cast<long long*>(dst));
+      break;
+    case ddb::DT_FLOAT:
+      if (UNLIKELY(hasNull)) {
+        NullFill<P>::template fill<float>(vec, dst, size);
+      } else {
+        vec->getFloat(0, size, reinterpret_cast<float*>(dst));
+      }
+      break;
+    case ddb::DT_DOUBLE:
+      if (UNLIKELY(hasNull)) {
+        NullFill<P>::template fill<double>(vec, dst, size);
+      } else {
+        vec->getDouble(0, size, reinterpret_cast<double*>(dst));
+      }
+      break;
+    default:
+      throw std::runtime_error("type error in Vector: " +
+        utils::DataTypeToString(type));
+  }
+}
+
+template <NullValuePolicy P>
+py::object fixedWidthArray(
+  const ddb::VectorSP &vec,
+  ddb::DATA_TYPE type,
+  bool hasNull,
+  size_t size)
+{
+  const char *dtype = fixedWidthDtype<P>(type, hasNull);
+  if (dtype == nullptr) {
+    return py::object();
+  }
+  py::object wrapped;
+  if (isSharable<P>(type, hasNull) &&
+    wrapVectorBuffer(vec, dtype, size, wrapped)) {
+    return wrapped;
+  }
+  py::array pyVec(py::dtype(dtype), {size}, {});
+  fillFixedWidth<P>(vec, type, hasNull, pyVec.mutable_data(), size);
+  return pyVec;
+}
+
+// fixedWidthArray with the policy chosen at runtime, a null object when the
+// vector needs Python objects
+py::object fixedWidthArray(
+  const ddb::VectorSP &vec,
+  ddb::DATA_TYPE type,
+  bool hasNull,
+  size_t size,
+  NullValuePolicy policy)
+{
+  switch (policy) {
+    case NullValuePolicy::ZERO:
+      return fixedWidthArray<NullValuePolicy::ZERO>(vec, type, hasNull, size);
+    case NullValuePolicy::SENTINEL:
+      return fixedWidthArray<NullValuePolicy::SENTINEL>(
+        vec, type, hasNull, size);
+    case NullValuePolicy::NAN_VALUE:
+    default:
+      return fixedWidthArray<NullValuePolicy::NAN_VALUE>(
+        vec, type, hasNull, size);
+  }
+}
+
+// convert the fixed width columns of a table on the conversion thread pool,
+// only allocating the numpy arrays needs the GIL, columns left unset in
+// converted are for the caller to convert
+template <NullValuePolicy P>
+void convertColumnsInParallel(
+  const ddb::TableSP &ddbTbl,
+  size_t parallelism,
+  std::vector<py::object> &converted)
+{
+  size_t columnSize = ddbTbl->columns();
+  std::vector<ddb::VectorSP> columns(columnSize);
+  std::vector<ddb::DATA_TYPE> types(columnSize);
+  std::vector<char> isFixedWidth(columnSize);
+  std::vector<char> hasNull(columnSize);
+  std::vector<void*> buffers(columnSize, nullptr);
+  for (size_t i = 0; i < columnSize; ++i) {
+    columns[i] = ddbTbl->getColumn(i);
+    types[i] = columns[i]->getType();
+    isFixedWidth[i] = columns[i]->getForm() == ddb::DF_VECTOR &&
+      fixedWidthDtype<P>(types[i], false) != nullptr;
+  }
+  {
+    py::gil_scoped_release release;
+    conversionPool().parallelFor(columnSize, parallelism, [&](size_t i) {
+      if (isFixedWidth[i]) {
+        hasNull[i] = columns[i]->hasNull();
+      }
+    });
+  }
+  for (size_t i = 0; i < columnSize; ++i) {
+    const char *dtype = fixedWidthDtype<P>(types[i], hasNull[i]);
+    if (!isFixedWidth[i] || dtype == nullptr) {
+      continue;
+    }
+    size_t size = columns[i]->size();
+    if (isSharable<P>(types[i], hasNull[i]) &&
+      wrapVectorBuffer(columns[i], dtype, size, converted[i])) {
+      continue;
+    }
+    py::array pyVec(py::dtype(dtype), {size}, {});
+    buffers[i] = pyVec.mutable_data();
+    converted[i] = pyVec;
+  }
+  {
+    py::gil_scoped_release release;
+    conversionPool().parallelFor(columnSize, parallelism, [&](size_t i) {
+      if (buffers[i] != nullptr) {
+        fillFixedWidth<P>(
+          columns[i], types[i], hasNull[i], buffers[i], columns[i]->size());
+      }
+    });
+  }
+}
+
+void convertColumnsInParallel(
+  const ddb::TableSP &ddbTbl,
+  const ConvertOptions &options,
+  std::vector<py::object> &converted)
+{
+  size_t parallelism = static_cast<size_t>(options.parallelism);
+  switch (options.nullValuePolicy) {
+    case NullValuePolicy::MASKED:
+    case NullValuePolicy::NULLABLE:
+      // masked columns are built through Python, converted one by one
+      break;
+    case NullValuePolicy::ZERO:
+      convertColumnsInParallel<NullValuePolicy::ZERO>(
+        ddbTbl, parallelism, converted);
+      break;
+    case NullValuePolicy::SENTINEL:
+      convertColumnsInParallel<NullValuePolicy::SENTINEL>(
+        ddbTbl, parallelism, converted);
+      break;
+    case NullValuePolicy::NAN_VALUE:
+    default:
+      convertColumnsInParallel<NullValuePolicy::NAN_VALUE>(
+        ddbTbl, parallelism, converted);
+      break;
+  }
+}
+
+// fill a fixed width vector into buffer, which is replaced when it is too
+// small or of another dtype; returns a view of the filled part, a null
+// object when the vector needs Python objects
+template <NullValuePolicy P>
+py::object fixedWidthInto(const ddb::VectorSP &vec, py::object &buffer)
+{
+  ddb::DATA_TYPE type = vec->getType();
+  if (fixedWidthDtype<P>(type, false) == nullptr) {
+    return py::object();
+  }
+  size_t size = vec->size();
+  bool hasNull = vec->hasNull();
+  const char *dtype = fixedWidthDtype<P>(type, hasNull);
+  if (dtype == nullptr) {
+    return py::object();
+  }
+  py::dtype pyDtype(dtype);
+  // only a flat, contiguous and writeable array can be filled in place,
+  // views with strides or of several dimensions are replaced
+  bool sameDtype = buffer && py::isinstance<py::array>(buffer) &&
+    py::array(buffer).dtype().equal(pyDtype) &&
+    py::array(buffer).ndim() == 1 &&
+    (py::array(buffer).flags() & py::array::c_style) &&
+    py::array(buffer).writeable();
+  if (!sameDtype ||
+    py::array(buffer).size() < static_cast<py::ssize_t>(size)) {
+    size_t capacity = size;
+    if (sameDtype) {
+      // grow by half at least, so slowly growing results settle quickly
+      size_t current = static_cast<size_t>(py::array(buffer).size());
+      capacity = std::max(size, current + current / 2);
+    }
+    buffer = py::array(pyDtype, {capacity}, {});
+  }
+  py::array pyVec(buffer);
+  void *dst = pyVec.mutable_data();
+  {
+    py::gil_scoped_release release;
+    fillFixedWidth<P>(vec, type, hasNull, dst, size);
+  }
+  return pyVec.attr("__getitem__")(
+    py::slice(0, static_cast<py::ssize_t>(size), 1));
+}
+
+// a BOOL, integral or floating vector as its values plus a validity mask,
+// a null object for other types. Values under the mask are left as they
+// are so the vector's buffer is shared whenever possible.
+py::object maskedArray(
+  const ddb::VectorSP &vec,
+  ddb::DATA_TYPE type,
+  size_t size,
+  NullValuePolicy policy)
+{
+  switch (type) {
+    case ddb::DT_BOOL:
+    case ddb::DT_CHAR:
+    case ddb::DT_SHORT:
+    case ddb::DT_INT:
+    case ddb::DT_LONG:
+      break;
+    case ddb::DT_FLOAT:
+    case ddb::DT_DOUBLE:
+      if (policy == NullValuePolicy::NULLABLE) {
+        // NaN already is the missing value of float columns in pandas
+        return fixedWidthArray<NullValuePolicy::NAN_VALUE>(
+          vec, type, vec->hasNull(), size);
+      }
+      break;
+    default:
+      return py::object();
+  }
+  bool hasNull = vec->hasNull();
+  // BOOL values must stay 0 or 1 for numpy
+  py::object values = type == ddb::DT_BOOL ?
+    fixedWidthArray<NullValuePolicy::ZERO>(vec, type, hasNull, size) :
+    fixedWidthArray<NullValuePolicy::SENTINEL>(vec, type, hasNull, size);
+  py::array mask(py::dtype("bool"), {size}, {});
+  bool *m = reinterpret_cast<bool*>(mask.mutable_data());
+  {
+    py::gil_scoped_release release;
+    if (!hasNull) {
+      std::memset(m, 0, size);
+    } else {
+      switch (type) {
+        case ddb::DT_BOOL:
+        case ddb::DT_CHAR:
+          convertByBlock<char, bool>(vec, m, size, kernels::nullMask);
+          break;
+        case ddb::DT_SHORT:
+          convertByBlock<short, bool>(vec, m, size, kernels::nullMask);
+          break;
+        case ddb::DT_INT:
+          convertByBlock<int, bool>(vec, m, size, kernels::nullMask);
+          break;
+        case ddb::DT_LONG:
+          convertByBlock<long long, bool>(vec, m, size, kernels::nullMask);
+          break;
+        case ddb::DT_FLOAT:
+          convertByBlock<float, bool>(vec, m, size, kernels::nullMask);
+          break;
+        default:
+          convertByBlock<double, bool>(vec, m, size, kernels::nullMask);
+          break;
+      }
+    }
+  }
+  if (policy == NullValuePolicy::MASKED) {
+    return pymodule::numpy_.attr("ma").attr("MaskedArray")(
+      values, py::arg("mask") = mask, py::arg("copy") = false);
+  }
+  py::object arrays = pymodule::pandas_.attr("arrays");
+  if (type == ddb::DT_BOOL) {
+    return arrays.attr("BooleanArray")(values, mask);
+  }
+  return arrays.attr("IntegerArray")(values, mask);
+}
+
+inline void setConst(
+  const ddb::VectorSP &vec, ddb::INDEX start, int len, const float *buf)
+{
+  vec->setFloat(start, len, buf);
+}
+
+inline void setConst(
+  const ddb::VectorSP &vec, ddb::INDEX start, int len, const double *buf)
+{
+  vec->setDouble(start, len, buf);
+}
+
+// overwrite the first size elements of a FLOAT/DOUBLE vector, NaN becomes
+// the null sentinel on the way in so the values are copied only once
+template <typename T>
+void fillWithoutNan(const ddb::VectorSP &vec, const T *src, size_t size)
+{
+  T *dst = reinterpret_cast<T*>(vec->getDataArray());
+  size_t nans = 0;
+  if (dst != nullptr) {
+    nans = kernels::nanToNull(src, dst, size);
+  } else {
+    const size_t blockSize = 4096;
+    T buf[blockSize];
+    for (size_t start = 0; start < size; start += blockSize) {
+      int len = static_cast<int>(std::min(blockSize, size - start));
+      nans += kernels::nanToNull(src + start, buf, len);
+      setConst(vec, static_cast<ddb::INDEX>(start), len, buf);
+    }
+  }
+  vec->setNullFlag(nans > 0);
+}
+
+// fill an empty FLOAT/DOUBLE vector
+template <typename T>
+void appendWithoutNan(const ddb::VectorSP &vec, const T *src, size_t size)
+{
+  vec->resize(static_cast<ddb::INDEX>(size));
+  fillWithoutNan(vec, src, size);
+}
+
+// call set(start, len, column) once per column of a column-major buffer
+template <typename T, typename Setter>
+void setByColumn(const T *src, size_t rows, size_t cols, Setter set)
+{
+  for (size_t j = 0; j < cols; ++j) {
+    set(static_cast<ddb::INDEX>(j * rows), static_cast<int>(rows),
+      src + j * rows);
+  }
+}
+
+// matrix from a 2-D numpy array, each column is copied straight out of the
+// Fortran-ordered buffer with one bulk set. Returns a null pointer for types
+// which are not stored with a fixed width.
+ddb::VectorSP matrixFromArray(py::array pyMat, ddb::DATA_TYPE type)
+{
+  size_t rows = pyMat.shape(0);
+  size_t cols = pyMat.shape(1);
+  switch (type) {
+    case ddb::DT_BOOL:
+    case ddb::DT_CHAR:
+    case ddb::DT_SHORT:
+    case ddb::DT_INT:
+    case ddb::DT_LONG:
+    case ddb::DT_DATE:
+    case ddb::DT_MONTH:
+    case ddb::DT_TIME:
+    case ddb::DT_MINUTE:
+    case ddb::DT_SECOND:
+    case ddb::DT_DATETIME:
+    case ddb::DT_TIMESTAMP:
+    case ddb::DT_NANOTIME:
+    case ddb::DT_NANOTIMESTAMP:
+    case ddb::DT_FLOAT:
+    case ddb::DT_DOUBLE:
+      break;
+    default:
+      return ddb::VectorSP();
+  }
+  if (!(pyMat.flags() & py::array::f_style)) {
+    // a C-ordered array is transposed by a single numpy copy
+    pyMat = pyfunction::asfortranarray_(pyMat);
+  }
+  ddb::VectorSP ddbMat = ddb::Util::createMatrix(type, cols, rows, cols);
+  const void *data = pyMat.data();
+  py::gil_scoped_release release;
+  switch (type) {
+    case ddb::DT_BOOL:
+      setByColumn(reinterpret_cast<const char*>(data), rows, cols,
+        [&](ddb::INDEX start, int len, const char *buf) {
+          ddbMat->setBool(start, len, buf);
+        });
+      break;
+    case ddb::DT_CHAR:
+      setByColumn(reinterpret_cast<const char*>(data), rows, cols,
+        [&](ddb::INDEX start, int len, const char *buf) {
+          ddbMat->setChar(start, len, buf);
+        });
+      break;
+    case ddb::DT_SHORT:
+      setByColumn(reinterpret_cast<const short*>(data), rows, cols,
+        [&](ddb::INDEX start, int len, const short *buf) {
+          ddbMat->setShort(start, len, buf);
+        });
+      break;
+    case ddb::DT_INT:
+      setByColumn(reinterpret_cast<const int*>(data), rows, cols,
+        [&](ddb::INDEX start, int len, const int *buf) {
+          ddbMat->setInt(start, len, buf);
+        });
+      break;
+    case ddb::DT_FLOAT:
+      fillWithoutNan(
+        ddbMat, reinterpret_cast<const float*>(data), rows * cols);
+      break;
+    case ddb::DT_DOUBLE:
+      fillWithoutNan(
+        ddbMat, reinterpret_cast<const double*>(data), rows * cols);
+      break;
+    default:
+      // LONG and the temporal types arrive as int64, as in the vector path
+      setByColumn(reinterpret_cast<const long long*>(data), rows, cols,
+        [&](ddb::INDEX start, int len, const long long *buf) {
+          ddbMat->setLong(start, len, buf);
+        });
+      break;
+  }
+  return ddbMat;
+}
+
+// SYMBOL vector from a dictionary and per row codes, code -1 is null. The
+// dictionary becomes the symbol base and the codes its indices, no string
+// is copied per row
+template <typename T>
+ddb::VectorSP symbolVector(
+  const std::vector<std::string> &dictionary,
+  const T *codes,
+  size_t size)
+{
+  ddb::SymbolBaseSP base = new ddb::SymbolBase();
+  int nullIndex = base->findAndInsert("");
+  std::vector<int> indexOf(dictionary.size());
+  for (size_t k = 0; k < dictionary.size(); ++k) {
+    indexOf[k] = base->findAndInsert(dictionary[k]);
+  }
+  // the vector takes over data
+  int *data = new int[std::max<size_t>(size, 1)];
+  bool containNull = false;
+  for (size_t i = 0; i < size; ++i) {
+    T code = codes[i];
+    if (code < 0) {
+      data[i] = nullIndex;
+      containNull = true;
+    } else {
+      data[i] = indexOf[code];
+    }
+  }
+  return ddb::Util::createSymbolVector(base, static_cast<ddb::INDEX>(size),
+    static_cast<ddb::INDEX>(size), true, data, nullptr, 0, containNull);
+}
+
+// STRING vector from str objects in one pass, appended block by block.
+// Returns a null pointer if some element is not a str.
+ddb::VectorSP plainStringVector(PyObject * const *p, size_t size)
+{
+  const size_t blockSize = 1024;
+  ddb::VectorSP vec = ddb::Util::createVector(ddb::DT_STRING, 0, size);
+  std::vector<std::string> buf(blockSize);
+  for (size_t start = 0; start < size; start += blockSize) {
+    size_t len = std::min(blockSize, size - start);
+    for (size_t j = 0; j < len; ++j) {
+      PyObject *obj = p[start + j];
+      if (!py::isinstance<py::str>(obj)) {
+        return ddb::VectorSP();
+      }
+      buf[j] = py::reinterpret_borrow<py::str>(obj).cast<std::string>();
+    }
+    vec->appendString(buf.data(), static_cast<int>(len));
+  }
+  return vec;
+}
+
+// STRING vector from an object array of str, SYMBOL instead when asked for.
+// A SYMBOL vector is dictionary-encoded while scanning, each distinct str
+// object is encoded to UTF-8 only once. Returns a null pointer if some
+// element is not a str.
+ddb::VectorSP stringVector(const py::array &pyVec, bool asSymbol)
+{
+  // a symbol base holds at most 2^21 distinct symbols
+  const size_t maxSymbols = 1 << 21;
+  size_t size = pyVec.size();
+  PyObject * const *p = reinterpret_cast<PyObject * const *>(pyVec.data());
+  if (!asSymbol) {
+    return plainStringVector(p, size);
+  }
+  std::unordered_map<PyObject*, int> codeOfObject;
+  std::unordered_map<std::string, int> codeOfString;
+  std::vector<std::string> dictionary;
+  std::vector<int> codes(size);
+  for (size_t i = 0; i < size; ++i) {
+    auto it = codeOfObject.find(p[i]);
+    if (it != codeOfObject.end()) {
+      codes[i] = it->second;
+      continue;
+    }
+    if (!py::isinstance<py::str>(p[i])) {
+      return ddb::VectorSP();
+    }
+    std::string str = py::reinterpret_borrow<py::str>(p[i]).cast<std::string>();
+    auto jt = codeOfString.find(str);
+    if (jt == codeOfString.end()) {
+      if (dictionary.size() == maxSymbols) {
+        throw std::runtime_error("<Python API Exception> a SYMBOL column "
+          "holds at most " + std::to_string(maxSymbols) + " distinct values");
+      }
+      jt = codeOfString.emplace(str, static_cast<int>(dictionary.size())).first;
+      dictionary.push_back(std::move(str));
+    }
+    codeOfObject.emplace(p[i], jt->second);
+    codes[i] = jt->second;
+  }
+  return symbolVector(dictionary, codes.data(), size);
+}
+
+// SYMBOL vector from the codes and categories of a pandas.Categorical, only
+// the categories are converted from Python. Returns a null pointer if some
+// category is not a str.
+ddb::VectorSP categoricalVector(py::object codes, py::object categories)
+{
+  std::vector<std::string> dictionary;
+  for (auto it = categories.begin(); it != categories.end(); ++it) {
+    if (!py::isinstance<py::str>(*it)) {
+      return ddb::VectorSP();
+    }
+    dictionary.push_back(it->cast<std::string>());
+  }
+  py::array_t<long long, py::array::c_style | py::array::forcecast>
+    pyCodes(codes);
+  return symbolVector(dictionary, pyCodes.data(), pyCodes.size());
+}
+
+// a 1-D numpy array as a vector, fixed width values are appended into reuse
+// instead of a new vector when its type matches
+ddb::ConstantSP arrayToDolphinDB(
+  py::array pyVec, ddb::DATA_TYPE type, ddb::VectorSP reuse)
+{
+  if (!(pyVec.flags() & py::array::c_style)) {
+    // e.g. a strided DataFrame column or a slice with step
+    pyVec = pyfunction::ascontiguousarray_(pyVec);
+  }
+  size_t size = pyVec.size();
+  ddb::VectorSP ddbVec;
+  if (!reuse.isNull() && reuse->getType() == type && type != ddb::DT_SYMBOL &&
+      type != ddb::DT_STRING && type != ddb::DT_ANY) {
+    // overwrite the previous contents in place, keeping the capacity
+    ddbVec = reuse;
+    ddbVec->resize(0);
+    ddbVec->setNullFlag(false);
+  } else {
+    ddbVec = ddb::Util::createVector(type, 0, size);
+  }
+  switch (type) {
+    case ddb::DT_BOOL:
+    {
+      ddbVec->appendBool(
+        reinterpret_cast<char*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_CHAR:
+    {
+      ddbVec->appendChar(
+        reinterpret_cast<char*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_SHORT:
+    {
+      ddbVec->appendShort(
+        reinterpret_cast<short*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_INT:
+    {
+      ddbVec->appendInt(
+        reinterpret_cast<int*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_LONG:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_DATE:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_MONTH:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_TIME:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_MINUTE:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_SECOND:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_DATETIME:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_TIMESTAMP:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_NANOTIME:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_NANOTIMESTAMP:
+    {
+      ddbVec->appendLong(
+        reinterpret_cast<long long*>(pyVec.mutable_data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_FLOAT:
+    {
+      appendWithoutNan(
+        ddbVec, reinterpret_cast<const float*>(pyVec.data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_DOUBLE:
+    {
+      // special handle for np.nan value as type(np.nan)=float
+      appendWithoutNan(
+        ddbVec, reinterpret_cast<const double*>(pyVec.data()), size);
+      return ddbVec;
+    }
+    case ddb::DT_SYMBOL:
+    case ddb::DT_STRING:
+    case ddb::DT_ANY:
+    {
+      // extra check (determine string vector or any vector)
+      ddb::VectorSP strVec = stringVector(pyVec, false);
+      if (!strVec.isNull()) {
+        return strVec;
+      }
+      for (auto it = pyVec.begin(); it != pyVec.end(); ++it) {
+        ddb::ConstantSP item = toDolphinDB(
+          py::reinterpret_borrow<py::object>(*it));
+        ddbVec->append(item);
+      }
+      return ddbVec;
+    }
+    default:
+    {
+      throw std::runtime_error("type error in numpy: " + utils::DataTypeToString(type));
+    }
+  }
+}
+
+// a DataFrame column, categorical columns become SYMBOL, str columns too
+// when stringAsSymbol is set
+ddb::ConstantSP columnToDolphinDB(
+  py::object column, ddb::VectorSP reuse, bool stringAsSymbol)
+{
+  if (py::isinstance(column.attr("dtype"), pytype::pdcategoricaldtype_)) {
+    py::object cat = column.attr("cat");
+    ddb::VectorSP ddbVec = categoricalVector(
+      cat.attr("codes").attr("values"), cat.attr("categories"));
+    if (!ddbVec.isNull()) {
+      return ddbVec;
+    }
+  }
+  py::array pyVec(column);
+  if (pyVec.ndim() == 1 && pyVec.dtype().equal(pytype::npobject_)) {
+    if (!(pyVec.flags() & py::array::c_style)) {
+      pyVec = pyfunction::ascontiguousarray_(pyVec);
+    }
+    ddb::VectorSP ddbVec = stringVector(pyVec, stringAsSymbol);
+    if (!ddbVec.isNull()) {
+      return ddbVec;
+    }
+  }
+  if (pyVec.ndim() == 1) {
+    return arrayToDolphinDB(
+      pyVec, utils::DataTypeFromNumpyArray(pyVec), reuse);
+  }
+  return toDolphinDB(pyVec);
+}
+
+}  // namespace
 
 py::object toPython(
   ddb::ConstantSP obj,
-  void (*nullValuePolicyForVector)(ddb::VectorSP))
+  const ConvertOptions &options)
 {
   if (obj.isNull() || obj->isNothing() || obj->isNull()) {
     return py::none();
@@ -232,8 +1247,22 @@ py::object toPython(
   ddb::DATA_FORM form = obj->getForm();
   if (form == ddb::DF_VECTOR) {
     ddb::VectorSP ddbVec = obj;
-    nullValuePolicyForVector(ddbVec);
     size_t size = ddbVec->size();
+    if (options.nullValuePolicy == NullValuePolicy::MASKED ||
+      options.nullValuePolicy == NullValuePolicy::NULLABLE) {
+      py::object pyVec = maskedArray(
+        ddbVec, type, size, options.nullValuePolicy);
+      if (pyVec) {
+        return pyVec;
+      }
+    }
+    if (fixedWidthDtype<NullValuePolicy::NAN_VALUE>(type, false) != nullptr) {
+      py::object pyVec = fixedWidthArray(
+        ddbVec, type, ddbVec->hasNull(), size, options.nullValuePolicy);
+      if (pyVec) {
+        return pyVec;
+      }
+    }
     switch (type) {
       case ddb::DT_VOID:
       {
@@ -248,175 +1277,12 @@ py::object toPython(
         if (UNLIKELY(ddbVec->hasNull())) {
           // Play with the raw api of Python, be careful about the ref count
           pyVec = pyVec.attr("astype")("object");
+          py::object nan = pymodule::numpy_.attr("nan");
           PyObject **p = reinterpret_cast<PyObject**>(pyVec.mutable_data());
           for (size_t i = 0; i < size; ++i) {
             if (UNLIKELY(ddbVec->getBool(i) == INT8_MIN)) {
               Py_DECREF(p[i]);
-              p[i] = pymodule::numpy_.attr("nan").ptr();
-            }
-          }
-        }
-        return pyVec;
-      }
-      case ddb::DT_CHAR:
-      {
-        py::array pyVec(py::dtype("int8"), {size}, {});
-        ddbVec->getChar(
-          0, size, reinterpret_cast<char *>(pyVec.mutable_data()));
-        if (UNLIKELY(ddbVec->hasNull())) {
-          pyVec = pyVec.attr("astype")("float64");
-          double *p = reinterpret_cast<double *>(pyVec.mutable_data());
-          for (size_t i = 0; i < size; ++i) {
-            if (UNLIKELY(ddbVec->getChar(i) == INT8_MIN)) {
-              utils::SET_NPNAN(p+i, 1);
-            }
-          }
-        }
-        return pyVec;
-      }
-      case ddb::DT_SHORT:
-      {
-        py::array pyVec(py::dtype("int16"), {size}, {});
-        ddbVec->getShort(
-          0, size, reinterpret_cast<short *>(pyVec.mutable_data()));
-        if (UNLIKELY(ddbVec->hasNull())) {
-          pyVec = pyVec.attr("astype")("float64");
-          double *p = reinterpret_cast<double *>(pyVec.mutable_data());
-          for (size_t i = 0; i < size; ++i) {
-            if (UNLIKELY(ddbVec->getShort(i) == INT16_MIN)) {
-              utils::SET_NPNAN(p+i, 1);
-            }
-          }
-        }
-        return pyVec;
-      }
-      case ddb::DT_INT:
-      {
-        py::array pyVec(py::dtype("int32"), {size}, {});
-        ddbVec->getInt(0, size, reinterpret_cast<int*>(pyVec.mutable_data()));
-        if (UNLIKELY(ddbVec->hasNull())) {
-          pyVec = pyVec.attr("astype")("float64");
-          double *p = reinterpret_cast<double*>(pyVec.mutable_data());
-          for (size_t i = 0; i < size; ++i) {
-            if (UNLIKELY(ddbVec->getInt(i) == INT32_MIN)) {
-              utils::SET_NPNAN(p+i, 1);
-            }
-          }
-        }
-        return pyVec;
-      }
-      case ddb::DT_LONG:
-      {
-        py::array pyVec(py::dtype("int64"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        if (UNLIKELY(ddbVec->hasNull())) {
-          pyVec = pyVec.attr("astype")("float64");
-          double *p = reinterpret_cast<double*>(pyVec.mutable_data());
-          for (size_t i = 0; i < size; ++i) {
-            if (UNLIKELY(ddbVec->getLong(i) == INT64_MIN)) {
-              utils::SET_NPNAN(p+i, 1);
-            }
-          }
-        }
-        return pyVec;
-      }
-      case ddb::DT_DATE:
-      {
-        py::array pyVec(py::dtype("datetime64[D]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        return pyVec;
-      }
-      case ddb::DT_MONTH:
-      {
-        py::array pyVec(py::dtype("datetime64[M]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        long long *p = reinterpret_cast<long long*>(pyVec.mutable_data());
-        for (size_t i = 0; i < size; ++i) {
-          if (UNLIKELY(p[i] == INT64_MIN)) {
-            continue;
-          }
-          p[i] -= 1970*12;
-        }
-        return pyVec;
-      }
-      case ddb::DT_TIME:
-      {
-        py::array pyVec(py::dtype("datetime64[ms]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        return pyVec;
-      }
-      case ddb::DT_MINUTE:
-      {
-        py::array pyVec(py::dtype("datetime64[m]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        return pyVec;
-      }
-      case ddb::DT_SECOND:
-      {
-        py::array pyVec(py::dtype("datetime64[s]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        return pyVec;
-      }
-      case ddb::DT_DATETIME:
-      {
-        py::array pyVec(py::dtype("datetime64[s]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        return pyVec;
-      }
-      case ddb::DT_TIMESTAMP:
-      {
-        py::array pyVec(py::dtype("datetime64[ms]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        return pyVec;
-      }
-      case ddb::DT_NANOTIME:
-      {
-        py::array pyVec(py::dtype("datetime64[ns]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        return pyVec;
-      }
-      case ddb::DT_NANOTIMESTAMP:
-      {
-        py::array pyVec(py::dtype("datetime64[ns]"), {size}, {});
-        ddbVec->getLong(
-          0, size, reinterpret_cast<long long*>(pyVec.mutable_data()));
-        return pyVec;
-      }
-      case ddb::DT_FLOAT:
-      {
-        py::array pyVec(py::dtype("float32"), {size}, {});
-        ddbVec->getFloat(
-          0, size, reinterpret_cast<float*>(pyVec.mutable_data()));
-        if (UNLIKELY(ddbVec->hasNull())) {
-          pyVec = pyVec.attr("astype")("float64");
-          auto p = reinterpret_cast<double*>(pyVec.mutable_data());
-          for (size_t i = 0; i < size; ++i) {
-            if (UNLIKELY(ddbVec->getFloat(i) == ddb::FLT_NMIN)) {
-              utils::SET_NPNAN(p+i, 1);
-            }
-          }
-        }
-        return pyVec;
-      }
-      case ddb::DT_DOUBLE:
-      {
-        py::array pyVec(py::dtype("float64"), {size}, {});
-        ddbVec->getDouble(
-          0, size, reinterpret_cast<double*>(pyVec.mutable_data()));
-        if (UNLIKELY(ddbVec->hasNull())) {
-          auto p = reinterpret_cast<double*>(pyVec.mutable_data());
-          for (size_t i = 0; i < size; ++i) {
-            if (UNLIKELY(ddbVec->getDouble(i) == ddb::DBL_NMIN)) {
-              utils::SET_NPNAN(p+i, 1);
+              p[i] = nan.inc_ref().ptr();
             }
           }
         }
@@ -426,26 +1292,20 @@ py::object toPython(
       case ddb::DT_STRING:
       {
         // handle numpy.array of symbols/strings
-        auto* objects = new PyObject*[size];
-        py::capsule deleter(objects, [](void *pp) {
-          delete[] reinterpret_cast<PyObject*>(pp);
-        });
-        for (size_t i = 0; i < size; ++i) {
-          objects[i] = py::str(ddbVec->getString(i)).inc_ref().ptr();
+        if (type == ddb::DT_SYMBOL && options.symbolAsCategorical) {
+          return symbolCategorical(ddbVec, size);
         }
-        return py::array(py::dtype("object"), {size}, {}, objects, deleter);
+        return stringArray(ddbVec, size, type == ddb::DT_SYMBOL);
       }
       case ddb::DT_ANY:
       {
-        // handle numpy.array of objects
-        auto* objects = new PyObject*[size];
-        py::capsule deleter(objects, [](void *pp) {
-          delete[] reinterpret_cast<PyObject*>(pp);
-        });
+        // handle numpy.array of objects, the array owns the references
+        py::array pyVec(py::dtype("object"), {size}, {});
+        PyObject **p = reinterpret_cast<PyObject**>(pyVec.mutable_data());
         for (size_t i = 0; i < size; ++i) {
-          objects[i] = toPython(ddbVec->get(i)).inc_ref().ptr();
+          p[i] = toPython(ddbVec->get(i), options).release().ptr();
         }
-        return py::array(py::dtype("object"), {size}, {}, objects, deleter);
+        return pyVec;
       }
       default:
       {
@@ -456,11 +1316,13 @@ py::object toPython(
   } else if (form == ddb::DF_TABLE) {
     ddb::TableSP ddbTbl = obj;
     size_t columnSize = ddbTbl->columns();
-    py::object dataframe = pymodule::pandas_.attr("DataFrame")();
-    for (size_t i = 0; i < columnSize; ++i) {
-      dataframe[ddbTbl->getColumnName(i).data()] = toPython(obj->getColumn(i));
+    // convert every column first and assemble the result once, assigning
+    // columns to a DataFrame one by one makes pandas copy them repeatedly
+    std::vector<py::object> converted(columnSize);
+    if (options.parallelism > 1 && columnSize > 1) {
+      convertColumnsInParallel(ddbTbl, options, converted);
     }
-    return dataframe;
+    return tableToPython(ddbTbl, converted, options);
   } else if (form == ddb::DF_SCALAR) {
     switch (type) {
       case ddb::DT_VOID:
@@ -514,11 +1376,12 @@ py::object toPython(
     py::dict pyDict;
     if (keyType == ddb::DT_STRING) {
       for (size_t i = 0; i < keys->size(); ++i) {
-        pyDict[keys->getString(i).data()] = toPython(values->get(i));
+        pyDict[keys->getString(i).data()] = toPython(values->get(i), options);
       }
     } else {
       for (size_t i = 0; i < keys->size(); ++i) {
-        pyDict[py::int_(keys->getLong(i))] = toPython(values->get(i));
+        pyDict[py::int_(keys->getLong(i))] =
+          toPython(values->get(i), options);
       }
     }
     return pyDict;
@@ -530,12 +1393,41 @@ py::object toPython(
     if (ddbMat->getCategory() == ddb::MIXED) {
       throw std::runtime_error("currently only support single typed matrix");
     }
+    // the matrix is stored column by column, so its flattened conversion is
+    // exactly the buffer of a Fortran-ordered (rows, cols) array
+    ConvertOptions flatOptions = options;
+    flatOptions.symbolAsCategorical = false;
+    // a masked or pandas nullable result cannot be reshaped into a matrix,
+    // such matrices fall back to NaN for nulls
+    if (options.nullValuePolicy == NullValuePolicy::MASKED ||
+        options.nullValuePolicy == NullValuePolicy::NULLABLE) {
+      flatOptions.nullValuePolicy = NullValuePolicy::NAN_VALUE;
+    }
     ddbMat->setForm(ddb::DF_VECTOR);
-    py::array pyMat = toPython(ddbMat);
-    py::object pyMatRowLabel = toPython(ddbMat->getRowLabel());
-    py::object pyMatColLabel = toPython(ddbMat->getColumnLabel());
-    pyMat.resize({cols, rows});
-    pyMat = pyMat.attr("transpose")();
+    py::array pyFlat = toPython(ddbMat, flatOptions);
+    ddbMat->setForm(ddb::DF_MATRIX);
+    py::ssize_t itemsize = pyFlat.itemsize();
+    py::array pyMat(pyFlat.dtype(),
+      {static_cast<py::ssize_t>(rows), static_cast<py::ssize_t>(cols)},
+      {itemsize, itemsize * static_cast<py::ssize_t>(rows)},
+      pyFlat.data(), pyFlat);
+    ddb::ConstantSP rowLabel = ddbMat->getRowLabel();
+    ddb::ConstantSP colLabel = ddbMat->getColumnLabel();
+    if (options.matrixFormat == MatrixFormat::DATAFRAME) {
+      py::object index = py::none();
+      py::object columns = py::none();
+      if (!rowLabel.isNull() && rowLabel->getType() != ddb::DT_VOID) {
+        index = toPython(rowLabel, options);
+      }
+      if (!colLabel.isNull() && colLabel->getType() != ddb::DT_VOID) {
+        columns = toPython(colLabel, options);
+      }
+      return pymodule::pandas_.attr("DataFrame")(pyMat,
+        py::arg("index") = index, py::arg("columns") = columns,
+        py::arg("copy") = false);
+    }
+    py::object pyMatRowLabel = toPython(rowLabel, options);
+    py::object pyMatColLabel = toPython(colLabel, options);
     py::list pyMatList;
     pyMatList.append(pyMat);
     pyMatList.append(pyMatRowLabel);
@@ -545,14 +1437,14 @@ py::object toPython(
     ddb::VectorSP ddbPair = obj;
     py::list pyPair;
     for (size_t i = 0; i < ddbPair->size(); ++i) {
-      pyPair.append(toPython(ddbPair->get(i)));
+      pyPair.append(toPython(ddbPair->get(i), options));
     }
     return pyPair;
   } else if (form == ddb::DF_SET) {
     ddb::VectorSP ddbSet = obj->keys();
     py::set pySet;
     for (size_t i = 0; i < ddbSet->size(); ++i) {
-      pySet.add(toPython(ddbSet->get(i)));
+      pySet.add(toPython(ddbSet->get(i), options));
     }
     return pySet;
   } else {
@@ -560,7 +1452,114 @@ py::object toPython(
   }
 }
 
-ddb::ConstantSP toDolphinDB(py::object obj)
+py::object tableToPython(
+  const ddb::TableSP &tbl,
+  std::vector<py::object> &converted,
+  const ConvertOptions &options)
+{
+  size_t columnSize = tbl->columns();
+  py::list names;
+  py::list arrays;
+  py::dict columns;
+  for (size_t i = 0; i < columnSize; ++i) {
+    py::str name(tbl->getColumnName(i));
+    if (!converted[i]) {
+      converted[i] = toPython(tbl->getColumn(i), options);
+    }
+    names.append(name);
+    arrays.append(converted[i]);
+    columns[name] = converted[i];
+  }
+  switch (options.tableFormat) {
+    case TableFormat::DICT:
+      return columns;
+    case TableFormat::RECARRAY:
+      return pymodule::numpy_.attr("rec").attr("fromarrays")(
+        arrays, py::arg("names") = names);
+    case TableFormat::DATAFRAME:
+    default:
+      return pymodule::pandas_.attr("DataFrame")(columns,
+        py::arg("columns") = names, py::arg("copy") = false);
+  }
+}
+
+py::object toPythonInto(
+  ddb::ConstantSP obj,
+  py::object &buffer,
+  const ConvertOptions &options)
+{
+  if (!obj.isNull() && obj->getForm() == ddb::DF_VECTOR) {
+    py::object view;
+    switch (options.nullValuePolicy) {
+      case NullValuePolicy::NAN_VALUE:
+        view = fixedWidthInto<NullValuePolicy::NAN_VALUE>(obj, buffer);
+        break;
+      case NullValuePolicy::ZERO:
+        view = fixedWidthInto<NullValuePolicy::ZERO>(obj, buffer);
+        break;
+      case NullValuePolicy::SENTINEL:
+        view = fixedWidthInto<NullValuePolicy::SENTINEL>(obj, buffer);
+        break;
+      default:
+        // masked results are built through Python, nothing to reuse
+        break;
+    }
+    if (view) {
+      return view;
+    }
+  }
+  return toPython(obj, options);
+}
+
+py::object toPythonInto(
+  ddb::ConstantSP obj,
+  std::vector<py::object> &buffers,
+  const ConvertOptions &options)
+{
+  if (!obj.isNull() && obj->getForm() == ddb::DF_TABLE) {
+    ddb::TableSP tbl = obj;
+    size_t columnSize = tbl->columns();
+    if (buffers.size() < columnSize) {
+      buffers.resize(columnSize);
+    }
+    std::vector<py::object> converted(columnSize);
+    for (size_t i = 0; i < columnSize; ++i) {
+      converted[i] = toPythonInto(tbl->getColumn(i), buffers[i], options);
+    }
+    return tableToPython(tbl, converted, options);
+  }
+  if (buffers.empty()) {
+    buffers.resize(1);
+  }
+  return toPythonInto(obj, buffers[0], options);
+}
+
+ddb::TableSP dataFrameToDolphinDB(
+  py::object dataframe,
+  std::vector<ddb::VectorSP> &reuse,
+  bool stringAsSymbol)
+{
+  py::object pyLabel = dataframe.attr("columns");
+  size_t columnSize = pyLabel.attr("size").cast<size_t>();
+  vector<std::string> columnNames;
+  columnNames.reserve(columnSize);
+  for (auto it = pyLabel.begin(); it != pyLabel.end(); ++it) {
+    columnNames.emplace_back(it->cast<std::string>());
+  }
+  reuse.resize(columnSize);
+  vector<ddb::ConstantSP> columns;
+  columns.reserve(columnSize);
+  for (size_t i = 0; i < columnSize; ++i) {
+    columns.emplace_back(
+      columnToDolphinDB(dataframe[columnNames[i].data()], reuse[i],
+        stringAsSymbol));
+    reuse[i] = columns.back();
+  }
+  ddb::TableSP ddbTbl = ddb::Util::createTable(columnNames, columns);
+  return ddbTbl;
+}
+
+ddb::ConstantSP toDolphinDB(py::object obj, bool stringAsSymbol)
 {
   if (py::isinstance(obj, pytype::nparray_)) {
     ddb::DATA_TYPE type = utils::DataTypeFromNumpyArray(obj);
@@ -570,156 +1569,16 @@ ddb::ConstantSP toDolphinDB(py::object obj)
         "numpy.ndarray with dimension > 2 is not supported");
     }
     if (pyVec.ndim() == 1) {
-      size_t size = pyVec.size();
-      ddb::VectorSP ddbVec;
-      ddbVec = ddb::Util::createVector(type, 0, size);
-      switch (type) {
-        case ddb::DT_BOOL:
-        {
-          ddbVec->appendBool(
-            reinterpret_cast<char*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_CHAR:
-        {
-          ddbVec->appendChar(
-            reinterpret_cast<char*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_SHORT:
-        {
-          ddbVec->appendShort(
-            reinterpret_cast<short*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_INT:
-        {
-          ddbVec->appendInt(
-            reinterpret_cast<int*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_LONG:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_DATE:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_MONTH:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_TIME:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_MINUTE:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_SECOND:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_DATETIME:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_TIMESTAMP:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_NANOTIME:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_NANOTIMESTAMP:
-        {
-          ddbVec->appendLong(
-            reinterpret_cast<long long*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_FLOAT:
-        {
-          ddbVec->appendFloat(
-            reinterpret_cast<float*>(pyVec.mutable_data()), size);
-          return ddbVec;
-        }
-        case ddb::DT_DOUBLE:
-        {
-          // special handle for np.nan value as type(np.nan)=float
-          ddbVec->appendDouble(
-            reinterpret_cast<double*>(pyVec.mutable_data()), size);
-          if (pyfunction::isnan_(pyfunction::sum_(pyVec)).cast<bool>()) {
-            auto p = reinterpret_cast<double*>(pyVec.mutable_data());
-            for (size_t i = 0; i < size; ++i) {
-              if (IS_NPNAN(p+i)) {
-                ddbVec->setDouble(i, ddb::DBL_NMIN);
-              }
-            }
-          }
-          return ddbVec;
-        }
-        case ddb::DT_SYMBOL:
-        case ddb::DT_STRING:
-        case ddb::DT_ANY:
-        {
-          // extra check (determine string vector or any vector)
-          type = ddb::DT_STRING;
-          for (auto it = pyVec.begin(); it != pyVec.end(); ++it) {
-            if (!py::isinstance(*it, py::str().get_type())) {
-              type = ddb::DT_ANY;
-              break;
-            }
-          }
-          ddbVec = ddb::Util::createVector(type, 0, size);
-          if (type == ddb::DT_ANY) {
-            for (auto it = pyVec.begin(); it != pyVec.end(); ++it) {
-              ddb::ConstantSP item = toDolphinDB(
-                py::reinterpret_borrow<py::object>(*it));
-              ddbVec->append(item);
-            }
-          } else {
-            vector<std::string> strs;
-            for (auto it = pyVec.begin(); it != pyVec.end(); ++it) {
-              strs.emplace_back(
-                py::reinterpret_borrow<py::str>(*it).cast<std::string>());
-            }
-            ddbVec->appendString(strs.data(), strs.size());
-          }
-          return ddbVec;
-        }
-        default:
-        {
-          throw std::runtime_error("type error in numpy: " + utils::DataTypeToString(type));
-        }
-      }
+      return arrayToDolphinDB(pyVec, type, ddb::VectorSP());
     } else {
+      ddb::VectorSP fastMat = matrixFromArray(pyVec, type);
+      if (!fastMat.isNull()) {
+        return fastMat;
+      }
       size_t rows = pyVec.shape(0);
       size_t cols = pyVec.shape(1);
-      size_t size = rows * cols;
       pyVec = pyVec.attr("transpose")().attr("reshape")(pyVec.size());
       ddb::ConstantSP ddbVec = toDolphinDB(pyVec);
-      // FIXME: consider batch?
       ddb::ConstantSP ddbMat = ddb::Util::createMatrix(type, cols, rows, cols);
       for (size_t i = 0; i < cols; ++i) {
         for (size_t j = 0; j < rows; ++j) {
@@ -729,22 +1588,15 @@ ddb::ConstantSP toDolphinDB(py::object obj)
       return ddbMat;
     }
   } else if (py::isinstance(obj, pytype::pddataframe_)) {
-    py::object dataframe = obj;
-    py::object pyLabel = dataframe.attr("columns");
-    size_t columnSize = pyLabel.attr("size").cast<size_t>();
-    vector<std::string> columnNames;
-    columnNames.reserve(columnSize);
-    for (auto it = pyLabel.begin(); it != pyLabel.end(); ++it) {
-      columnNames.emplace_back(it->cast<std::string>());
-    }
-    vector<ddb::ConstantSP> columns;
-    columns.reserve(columnSize);
-    for (size_t i = 0; i < columnSize; ++i) {
-      columns.emplace_back(
-        toDolphinDB(py::array(dataframe[columnNames[i].data()])));
+    std::vector<ddb::VectorSP> reuse;
+    return dataFrameToDolphinDB(obj, reuse, stringAsSymbol);
+  } else if (py::isinstance(obj, pytype::pdcategorical_)) {
+    ddb::VectorSP ddbVec = categoricalVector(
+      obj.attr("codes"), obj.attr("categories"));
+    if (!ddbVec.isNull()) {
+      return ddbVec;
     }
-    ddb::TableSP ddbTbl = ddb::Util::createTable(columnNames, columns);
-    return ddbTbl;
+    return toDolphinDB(pymodule::numpy_.attr("asarray")(obj));
   } else if (py::isinstance(obj, pytype::pynone_)) {
     return ddb::Util::createNullConstant(ddb::DT_DOUBLE);
   } else if (py::isinstance(obj, pytype::pybool_)) {
@@ -807,7 +1659,7 @@ ddb::ConstantSP toDolphinDB(py::object obj)
     int types = 0;
     int forms = 1;
     for (size_t i = 0; i < size; ++i) {
-      _ddbVec.push_back(toDolphinDB(tuple[i]));
+      _ddbVec.push_back(toDolphinDB(tuple[i], stringAsSymbol));
       if (_ddbVec.back()->isNull()) {
         continue;
       }
@@ -840,7 +1692,7 @@ ddb::ConstantSP toDolphinDB(py::object obj)
     int types = 0;
     int forms = 1;
     for (size_t i = 0; i < size; ++i) {
-      _ddbVec.push_back(toDolphinDB(list[i]));
+      _ddbVec.push_back(toDolphinDB(list[i], stringAsSymbol));
       if (_ddbVec.back()->isNull()) {
         continue;
       }
@@ -880,8 +1732,8 @@ ddb::ConstantSP toDolphinDB(py::object obj)
     for (auto it = pyDict.begin(); it != pyDict.end(); ++it) {
       _ddbKeyVec.push_back(
         toDolphinDB(py::reinterpret_borrow<py::object>(it->first)));
-      _ddbValVec.push_back(
-        toDolphinDB(py::reinterpret_borrow<py::object>(it->second)));
+      _ddbValVec.push_back(toDolphinDB(
+        py::reinterpret_borrow<py::object>(it->second), stringAsSymbol));
       if (_ddbKeyVec.back()->isNull() || _ddbValVec.back()->isNull()) {
         continue;
       }
@@ -943,6 +1795,8 @@ ddb::ConstantSP toDolphinDB(py::object obj)
     } else {
       throw std::runtime_error("unsupported numpy.datetime64 dtype");
     }
+  } else if (arrow::isArrow(obj)) {
+    return arrow::fromArrow(obj);
   } else {
     throw std::runtime_error("unrecognized Python type: " +
       py::str(obj.get_type()).cast<std::string>());
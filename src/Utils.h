@@ -26,7 +26,9 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/numpy.h>
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include <DolphinDB.h>
 #include <Types.h>
@@ -58,6 +60,8 @@ namespace pyfunction
 
 extern const handle isnan_;
 extern const handle sum_;
+extern const handle ascontiguousarray_;
+extern const handle asfortranarray_;
 
 }
 
@@ -69,6 +73,8 @@ extern const handle datetime64_;
 
 // pandas types (use isinstance)
 extern const handle pddataframe_;
+extern const handle pdcategorical_;
+extern const handle pdcategoricaldtype_;
 
 // numpy dtypes (instances of dtypes, use equal)
 extern const handle nparray_;
@@ -108,6 +114,97 @@ constexpr uint64_t npnan_ = 9221120237041090560LL;
 namespace utils
 {
 
+// how a DolphinDB table is returned to Python
+enum class TableFormat {
+  DATAFRAME,  // pandas.DataFrame
+  DICT,       // dict of column name -> numpy.ndarray
+  RECARRAY    // numpy.recarray
+};
+
+// how a DolphinDB matrix is returned to Python, the array is Fortran-ordered
+enum class MatrixFormat {
+  LIST,       // [numpy.ndarray, row labels, column labels]
+  DATAFRAME   // pandas.DataFrame indexed by the labels
+};
+
+// how nulls of BOOL, integral and floating vectors are returned, temporal
+// vectors always use NaT and strings an empty str
+enum class NullValuePolicy {
+  NAN_VALUE,  // NaN, vectors with nulls widen to float64 (BOOL to object)
+  ZERO,       // 0 (False) in the vector's own dtype
+  SENTINEL,   // the DolphinDB null values, e.g. INT_MIN, in the own dtype
+  MASKED,     // numpy.ma.MaskedArray of the own dtype
+  NULLABLE    // pandas Int8..Int64/boolean arrays, floating vectors use NaN
+};
+
+// options steering toPython, passed down to every nested conversion
+struct ConvertOptions {
+  TableFormat tableFormat = TableFormat::DATAFRAME;
+  MatrixFormat matrixFormat = MatrixFormat::LIST;
+  // threads converting the columns of a table, 1 converts serially
+  int parallelism = 1;
+  // SYMBOL vectors become pandas.Categorical instead of object arrays
+  bool symbolAsCategorical = false;
+  NullValuePolicy nullValuePolicy = NullValuePolicy::NAN_VALUE;
+};
+
+// getXXXConst only copies into buf when the vector is not contiguous
+inline const char *getConst(
+  const ddb::VectorSP &vec, ddb::INDEX start, int len, char *buf)
+{
+  return vec->getCharConst(start, len, buf);
+}
+
+inline const short *getConst(
+  const ddb::VectorSP &vec, ddb::INDEX start, int len, short *buf)
+{
+  return vec->getShortConst(start, len, buf);
+}
+
+inline const int *getConst(
+  const ddb::VectorSP &vec, ddb::INDEX start, int len, int *buf)
+{
+  return vec->getIntConst(start, len, buf);
+}
+
+inline const long long *getConst(
+  const ddb::VectorSP &vec, ddb::INDEX start, int len, long long *buf)
+{
+  return vec->getLongConst(start, len, buf);
+}
+
+inline const float *getConst(
+  const ddb::VectorSP &vec, ddb::INDEX start, int len, float *buf)
+{
+  return vec->getFloatConst(start, len, buf);
+}
+
+inline const double *getConst(
+  const ddb::VectorSP &vec, ddb::INDEX start, int len, double *buf)
+{
+  return vec->getDoubleConst(start, len, buf);
+}
+
+// copy a vector block by block through kernel(src, dst, len), fast vectors
+// hand out their own buffer so every element is read and written once
+template <typename T, typename D>
+void convertByBlock(
+  const ddb::VectorSP &vec,
+  D *dst,
+  size_t size,
+  void (*kernel)(const T*, D*, size_t))
+{
+  const size_t blockSize = 4096;
+  T buf[blockSize];
+  for (size_t start = 0; start < size; start += blockSize) {
+    int len = static_cast<int>(std::min(blockSize, size - start));
+    const T *src = getConst(vec, static_cast<ddb::INDEX>(start), len, buf);
+    kernel(src, dst + start, len);
+  }
+}
+
+TableFormat TableFormatFromString(const std::string &format);
+MatrixFormat MatrixFormatFromString(const std::string &format);
 std::string DataCategoryToString(ddb::DATA_CATEGORY cate) noexcept;
 std::string DataFormToString(ddb::DATA_FORM form) noexcept;
 std::string DataTypeToString(ddb::DATA_TYPE type) noexcept;
@@ -115,8 +212,37 @@ inline void SET_NPNAN(void *p, size_t len = 1);
 inline void SET_DDBNAN(void *p, size_t len = 1);
 inline bool IS_NPNAN(void *p);
 ddb::DATA_TYPE DataTypeFromNumpyArray(py::array array);
-py::object toPython(ddb::ConstantSP obj, void (*nullValuePolicyForVector)(ddb::VectorSP) = [](ddb::VectorSP){});
-ddb::ConstantSP toDolphinDB(py::object obj);
+py::object toPython(
+  ddb::ConstantSP obj,
+  const ConvertOptions &options = ConvertOptions());
+// assemble a table in options.tableFormat, columns left null in converted
+// are converted with toPython first
+py::object tableToPython(
+  const ddb::TableSP &tbl,
+  std::vector<py::object> &converted,
+  const ConvertOptions &options);
+// toPython, but a fixed width vector is written into buffer (reallocated
+// when too small or of another dtype) and a view of it is returned, so the
+// memory is reused by the next call
+py::object toPythonInto(
+  ddb::ConstantSP obj,
+  py::object &buffer,
+  const ConvertOptions &options);
+// toPythonInto for a whole result, column i of a table (a vector) is written
+// into buffers[i] (buffers[0]), buffers grows to the number of columns
+py::object toPythonInto(
+  ddb::ConstantSP obj,
+  std::vector<py::object> &buffers,
+  const ConvertOptions &options);
+// str columns of DataFrames are uploaded as SYMBOL with stringAsSymbol,
+// otherwise as STRING; categorical columns are always SYMBOL
+ddb::ConstantSP toDolphinDB(py::object obj, bool stringAsSymbol = false);
+// toDolphinDB for a DataFrame, fixed width columns are written into the
+// vectors of reuse when the types match and reuse holds the new columns
+ddb::TableSP dataFrameToDolphinDB(
+  py::object dataframe,
+  std::vector<ddb::VectorSP> &reuse,
+  bool stringAsSymbol = false);
 
 }  // namespace utils
 
@@ -23,13 +23,21 @@
 #include <pybind11/pybind11.h>
 
 #include "Session.h"
+#include "ConnectionPool.h"
+#include "PartitionedTableWriter.h"
+#include "AsyncWriter.h"
 #include "Streaming.h"
 
 namespace py = pybind11;
 namespace ddb = dolphindb;
 
 using Session = pydolphindb::Session;
+using ConnectionPool = pydolphindb::ConnectionPool;
+using PartitionedTableWriter = pydolphindb::PartitionedTableWriter;
+using AsyncWriter = pydolphindb::AsyncWriter;
 using Streaming = pydolphindb::Streaming;
+using StreamRing = pydolphindb::StreamRing;
+using ChunkedResult = pydolphindb::ChunkedResult;
 
 PYBIND11_MODULE(pydolphindbimpl, m)
 {
@@ -44,17 +52,112 @@ PYBIND11_MODULE(pydolphindbimpl, m)
       (py::object (Session::*)(const std::string&))&Session::run)
     .def("run",
       (py::object (Session::*)(const std::string&, py::args))&Session::run)
+    .def("runArrow", &Session::runArrow)
+    .def("runInto", &Session::runInto)
+    .def("runChunked", &Session::runChunked,
+      py::arg("script"), py::arg("chunkRows"), py::arg("reuseBuffers") = false,
+      py::keep_alive<0, 1>())
+    .def("runAsync",
+      (py::object (Session::*)(const std::string&))&Session::runAsync)
+    .def("runAsync",
+      (py::object (Session::*)(const std::string&, py::args))
+      &Session::runAsync)
     .def("upload", &Session::upload)
+    .def("appendBatched", &Session::appendBatched,
+      py::arg("tableName"), py::arg("dataframe"), py::arg("batchRows"))
     .def("nullValueToZero", &Session::nullValueToZero)
-    .def("nullValueToNan", &Session::nullValueToNan);
+    .def("nullValueToNan", &Session::nullValueToNan)
+    .def("nullValueToSentinel", &Session::nullValueToSentinel)
+    .def("nullValueToMasked", &Session::nullValueToMasked)
+    .def("nullValueToNullable", &Session::nullValueToNullable)
+    .def("setTableFormat", &Session::setTableFormat)
+    .def("setMatrixFormat", &Session::setMatrixFormat)
+    .def("setConvertParallelism", &Session::setConvertParallelism)
+    .def("setSymbolAsCategorical", &Session::setSymbolAsCategorical)
+    .def("setStringAsSymbol", &Session::setStringAsSymbol)
+    .def("setResultBuffers", &Session::setResultBuffers);
+
+  py::class_<ChunkedResult>(m, "chunkedResult")
+    .def("__iter__", [](ChunkedResult &self) -> ChunkedResult& {
+      return self;
+    }, py::return_value_policy::reference)
+    .def("__next__", &ChunkedResult::next)
+    .def("next", &ChunkedResult::next)
+    .def("close", &ChunkedResult::close);
+
+  py::class_<ConnectionPool>(m, "connectionPool")
+    .def(py::init<const std::string&, int, int,
+      const std::string&, const std::string&>(),
+      py::arg("host"), py::arg("port"), py::arg("size"),
+      py::arg("userId") = "", py::arg("password") = "")
+    .def("run",
+      (py::object (ConnectionPool::*)(const std::string&))
+      &ConnectionPool::run)
+    .def("run",
+      (py::object (ConnectionPool::*)(const std::string&, py::args))
+      &ConnectionPool::run)
+    .def("upload",
+      (void (ConnectionPool::*)(py::dict))&ConnectionPool::upload)
+    .def("close", &ConnectionPool::close)
+    .def("size", &ConnectionPool::size);
+
+  py::class_<PartitionedTableWriter>(m, "partitionedTableWriter")
+    .def(py::init<const std::string&, int, const std::string&,
+      const std::string&, const std::string&, const std::string&,
+      const std::string&, int, int, int>(),
+      py::arg("host"), py::arg("port"), py::arg("userId"),
+      py::arg("password"), py::arg("dbPath"), py::arg("tableName"),
+      py::arg("partitionColumn"), py::arg("threads"), py::arg("batchSize"),
+      py::arg("throttle"))
+    .def("insert", &PartitionedTableWriter::insert)
+    .def("flush", &PartitionedTableWriter::flush)
+    .def("pending", &PartitionedTableWriter::pending)
+    .def("close", &PartitionedTableWriter::close);
+
+  py::class_<AsyncWriter>(m, "asyncWriter")
+    .def(py::init<const std::string&, int, const std::string&,
+      const std::string&, const std::string&, int, int, py::object>(),
+      py::arg("host"), py::arg("port"), py::arg("userId"),
+      py::arg("password"), py::arg("tableName"), py::arg("batchSize"),
+      py::arg("throttle"), py::arg("onError"))
+    .def("insert", &AsyncWriter::insert)
+    .def("insertBatch", &AsyncWriter::insertBatch)
+    .def("flush", &AsyncWriter::flush)
+    .def("pending", &AsyncWriter::pending)
+    .def("close", &AsyncWriter::close);
 
   py::class_<Streaming>(m, "streaming")
     .def(py::init<>())
     .def("listen", &Streaming::listen)
-    .def("subscribe", &Streaming::subscribe)
+    .def("setWorkers", &Streaming::setWorkers)
+    .def("subscribe", &Streaming::subscribe,
+      py::arg("host"), py::arg("port"), py::arg("handler"),
+      py::arg("tableName"), py::arg("actionName"), py::arg("offset"),
+      py::arg("resub"), py::arg("filter"), py::arg("batchSize") = 0,
+      py::arg("throttle") = 100, py::arg("keyColumn") = -1)
+    .def("subscribeNative", &Streaming::subscribeNative,
+      py::arg("host"), py::arg("port"), py::arg("callback"),
+      py::arg("tableName"), py::arg("actionName"), py::arg("offset"),
+      py::arg("resub"), py::arg("filter"), py::arg("batchSize") = 1,
+      py::arg("throttle") = 100, py::arg("keyColumn") = -1,
+      py::arg("userData") = 0)
+    .def("subscribeAggregated", &Streaming::subscribeAggregated,
+      py::arg("host"), py::arg("port"), py::arg("handler"),
+      py::arg("tableName"), py::arg("actionName"), py::arg("offset"),
+      py::arg("resub"), py::arg("filter"), py::arg("keyColumn"),
+      py::arg("timeColumn"), py::arg("window"), py::arg("aggregators"))
+    .def("subscribePolling", &Streaming::subscribePolling,
+      py::arg("host"), py::arg("port"), py::arg("tableName"),
+      py::arg("actionName"), py::arg("offset"), py::arg("resub"),
+      py::arg("filter"), py::arg("capacity"))
     .def("unsubscribe", &Streaming::unsubscribe)
     .def("getSubscriptionTopics", &Streaming::getSubscriptionTopics);
 
+  py::class_<StreamRing, std::shared_ptr<StreamRing>>(m, "streamPoller")
+    .def("poll", &StreamRing::poll,
+      py::arg("maxRows") = 0, py::arg("timeout") = 0)
+    .def("size", &StreamRing::size);
+
 #ifdef VERSION_INFO
   m.attr("__version__") = VERSION_INFO;
 #else